@@ -59,16 +59,15 @@ void GameOfLife::update() {
     // Create compressed version for period checking
     // Simply done by using only one bit per cell instead of a full byte
     // This reduces storage needs and speeds up comparison
-    // This can be considered to be a very specific perfect hash, since no collisions
-    // are possible.
+    // Each column spans as many words as its height needs, so every cell is kept and
+    // this can be considered to be a very specific perfect hash without collisions.
     uint idx = generation % GOL_MAX_PERIOD_TRACK;
     for (int x = 0; x < W; ++x) {
-        uint32_t line = 0;
+        uint32_t* line = prev_universes[idx][x];
+        memset(line, 0, GOL_COLUMN_WORDS * sizeof(uint32_t));
         for (int y = 0; y < H; ++y) {
-            line |= universe[y][x]&1;
-            line <<= 1;
+            line[y / 32] |= (uint32_t)(universe[y][x]&1) << (y % 32);
         }
-        prev_universes[idx][x] = line;
     }
 }
 
@@ -6,6 +6,8 @@
 
 #define GOL_MAX_PERIOD_TRACK 8
 #define GOL_RESTART_PERIOD 4
+// 32-bit words needed to hold one column of the compressed universe
+#define GOL_COLUMN_WORDS ((DISPLAY_HEIGHT+31)/32)
 
 class GameOfLife {
 public:
@@ -23,8 +25,10 @@ private:
 
     bool compare_compressed_universes(int a, int b) {
         for (int i = 0; i < DISPLAY_WIDTH; ++i) {
-            if (prev_universes[a][i] != prev_universes[b][i]) {
-                return false;
+            for (int j = 0; j < GOL_COLUMN_WORDS; ++j) {
+                if (prev_universes[a][i][j] != prev_universes[b][i][j]) {
+                    return false;
+                }
             }
         }
         return true;
@@ -37,7 +41,7 @@ private:
     int tickcounter = 0;
 
     bool periodic_autorestart{};
-    uint32_t prev_universes[GOL_MAX_PERIOD_TRACK][DISPLAY_WIDTH]{};
+    uint32_t prev_universes[GOL_MAX_PERIOD_TRACK][DISPLAY_WIDTH][GOL_COLUMN_WORDS]{};
 
     friend void gol_draw(uint32_t frame);
 };
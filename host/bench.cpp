@@ -0,0 +1,480 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "particlesim.h"
+#include "simulation.h"
+#include "sand.h"
+#include "worksplit.h"
+
+#include "images/img_all.h"
+#include "gol/gol_all.h"
+
+/*
+ * Host benchmark for Simulation::iterate
+ *
+ * Runs every stage from active_stages.def under a set of scripted tilt inputs
+ * and reports the time per tick. Generated half-full 64x32 and 64x64 worlds
+ * are run as well, each with its own instantiation of the simulation. Sand stages
+ * and generated sand worlds, up to a completely full one, run on the sand engine. The inputs are fed through the same scaling
+ * as in main(), so results should be comparable to the SIM= output on the Pico,
+ * apart from the obviously much faster CPU.
+ *
+ * Usage: particlesim_bench [-t ticks] [-s stage] [-i script] [-m sortmode] [-v speed] [-A] [-R] [-2] [-C]
+ *
+ * -s and -i take a substring of the stage or script name to filter by.
+ * -m selects the sort mode, one of none, full or incremental (the default).
+ * -v sets the speed limit of all particle stages, in cells per tick up to SIM_MAX_SPEED.
+ * -A disables skipping of resting particles, -R disables random jitter for all stages.
+ * -2 splits the velocity pass with a second thread standing in for core1. It helps
+ * whenever it can, so the timings are not representative of the Pico, but the hashes
+ * must be the same as without it.
+ * -C runs every particle simulation a second time with -A and fails if the hashes differ,
+ * since skipping resting particles must not change the results.
+ *
+ * The rest column is the mean percentage of particles skipped as resting.
+ *
+ * The sort column is the mean time spent sorting per tick. Since the simulation
+ * measures it in us, it is only accurate when averaged over many ticks.
+ *
+ * The hash column is computed from the final particle positions and can be used
+ * to check that an optimization did not change the simulation results.
+ * The sort and rest columns do not apply to the sand engine and are always 0 there.
+ *
+ * When built with -DPARTICLESIM_STATS=ON, every run of the particle simulation is
+ * followed by the mean of its workload counters per tick, see sim_stats_t.
+ */
+
+#include "stages.cpp"
+
+// Normally defined in particlesim.cpp, referenced by anim_helpers.cpp
+uint32_t anim_framebuf[DISPLAY_HEIGHT*DISPLAY_WIDTH];
+
+// 30 seconds of simulated time
+#define BENCH_DEFAULT_TICKS (PHYSICS_TPS*30)
+
+// Seed for random jitter, reset before every run
+#define BENCH_SEED 1
+
+// Velocity pass chunks handed out and done by the helper thread with -2
+static uint64_t bench_split_chunks = 0;
+static uint64_t bench_split_helped = 0;
+
+// Normalized accelerometer reading, in g, already in simulation axes
+typedef struct tilt {
+    float x, y, z;
+} tilt_t;
+
+typedef struct tilt_script {
+    const char* name;
+    tilt_t (*func)(uint32_t tick);
+} tilt_script_t;
+
+static uint32_t bench_hash(uint32_t x) {
+    // Integer hash from https://github.com/skeeto/hash-prospector
+    x ^= x >> 16;
+    x *= 0x7feb352du;
+    x ^= x >> 15;
+    x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+static tilt_t tilt_rest(uint32_t tick) {
+    // Panel standing upright, particles settle at the bottom
+    return {0.0f, 1.0f, 0.05f};
+}
+
+static tilt_t tilt_rotate(uint32_t tick) {
+    // Slowly turned around once every four seconds
+    float a = (float)(2*M_PI) * (float)(tick % (4*PHYSICS_TPS)) / (float)(4*PHYSICS_TPS);
+    return {sinf(a), cosf(a), 0.1f};
+}
+
+static tilt_t tilt_shake(uint32_t tick) {
+    // Violently shaken, new random direction 20 times a second
+    uint32_t h = bench_hash(tick / (PHYSICS_TPS/20));
+    float a = (float)(2*M_PI) * (float)(h & 0xFFFF) / 65536.0f;
+    float m = 1.0f + 1.5f * (float)(h >> 16) / 65536.0f;
+    return {m*sinf(a), m*cosf(a), 0.5f};
+}
+
+static const char* sortmode_names[] = {
+        "none",
+        "full",
+        "incremental",
+};
+
+static const tilt_script_t scripts[] = {
+        {"rest", tilt_rest},
+        {"rotate", tilt_rotate},
+        {"shake", tilt_shake},
+};
+
+// A stage from active_stages.def or a generated world
+typedef struct bench_world {
+    const char* name;
+    STAGE_ENGINE engine;
+    uint32_t w, h;
+    const uint32_t* bg;
+    const uint32_t* particles;
+    uint32_t particlecount;
+    uint8_t scale, elasticity;
+    bool rand;
+    uint8_t speed;
+} bench_world_t;
+
+template<class Sim>
+static uint32_t particle_hash(const Sim* sim) {
+    // FNV-1a over all particle positions
+    uint32_t h = 2166136261u;
+    for (int i = 0; i < sim->particlecount; ++i) {
+        h = (h ^ (uint32_t)sim->positions[i].x) * 16777619u;
+        h = (h ^ (uint32_t)sim->positions[i].y) * 16777619u;
+    }
+    return h;
+}
+
+template<class Sand>
+static uint32_t grain_hash(Sand* sand) {
+    // FNV-1a over all published grains, in row order
+    const particle_cell_t* cells = sand->publish();
+    uint32_t h = 2166136261u;
+    for (int i = 0; i < sand->particlecount; ++i) {
+        h = (h ^ (uint32_t)cells[i].x) * 16777619u;
+        h = (h ^ (uint32_t)cells[i].y) * 16777619u;
+        h = (h ^ sand->palette[cells[i].color]) * 16777619u;
+    }
+    return h;
+}
+
+static void generate_world(bench_world_t* world, const char* name, STAGE_ENGINE engine, uint32_t w, uint32_t h,
+                           uint32_t count) {
+    // Empty world with count cells filled with a particle, randomly placed
+    uint32_t* bg = new uint32_t[w*h]();
+    uint32_t* particles = new uint32_t[count*3];
+
+    std::vector<uint32_t> cells(w*h);
+    for (uint32_t i = 0; i < w*h; ++i) {
+        cells[i] = i;
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+        // Partial Fisher-Yates shuffle
+        uint32_t j = i + bench_hash(i) % (w*h - i);
+        std::swap(cells[i], cells[j]);
+
+        particles[i*3] = cells[i] % w;
+        particles[i*3+1] = cells[i] / w;
+        particles[i*3+2] = COLOR_HSV((bench_hash(cells[i]) % 16) * 4096, 255, 255);
+    }
+
+    *world = {name, engine, w, h, bg, particles, count, MPU_SCALE, SIM_ELASTICITY, engine == STAGE_ENGINE_PARTICLES, 1};
+}
+
+template<class Sim>
+static uint32_t run_bench(const bench_world_t* world, const tilt_script_t* script, uint32_t ticks, SIM_SORTMODE sortmode,
+                      bool activeset, worksplit_t* split) {
+    Sim* sim = new Sim(MPU_SCALE, SIM_ELASTICITY, sortmode);
+    sim->activeset = activeset;
+    sim->split = split;
+
+    // Same as start_stage() in particlesim.cpp
+    sim->clearAll();
+    sim->loadBackground(world->bg);
+    sim->loadParticles(world->particles, world->particlecount);
+
+    sim->scale = world->scale;
+    sim->elasticity = world->elasticity;
+    sim->rand = world->rand;
+    sim->speed = world->speed;
+
+    sim->seed(BENCH_SEED);
+
+    std::vector<uint32_t> samples(ticks);
+    uint64_t total = 0;
+    uint64_t sorttotal = 0;
+    uint64_t sleepingtotal = 0;
+#if SIM_STATS
+    sim_stats_t statstotal = {};
+#endif
+
+    for (uint32_t t = 0; t < ticks; ++t) {
+        tilt_t a = script->func(t);
+
+        auto ts = std::chrono::steady_clock::now();
+        sim->iterate((int) (a.x * PHYSICS_PRESCALE), (int) (a.y * PHYSICS_PRESCALE),
+                     (int) (a.z * PHYSICS_PRESCALE));
+        auto te = std::chrono::steady_clock::now();
+
+        samples[t] = (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(te - ts).count();
+        total += samples[t];
+        sorttotal += sim->sorttime;
+        sleepingtotal += sim->sleepingcount;
+#if SIM_STATS
+        statstotal.moved += sim->stats.moved;
+        statstotal.walls += sim->stats.walls;
+        statstotal.collisions += sim->stats.collisions;
+        statstotal.diagonals += sim->stats.diagonals;
+        statstotal.clamps += sim->stats.clamps;
+        statstotal.sortmoves += sim->stats.sortmoves;
+#endif
+        if (split != nullptr) {
+            bench_split_chunks += (sim->particlecount+SIM_SPLIT_CHUNK-1)/SIM_SPLIT_CHUNK;
+            bench_split_helped += split->helped;
+        }
+    }
+
+    std::sort(samples.begin(), samples.end());
+
+    double rest = sim->particlecount ? sleepingtotal * 100.0 / ticks / sim->particlecount : 0.0;
+    sim->wakeAll();
+
+    double mean = (double)total / ticks;
+    printf("%-20s %-8s %5lu %9.0f %10.0f %9u %9u %9u %9u %9.0f %5.1f  %08x\n",
+           world->name,
+           script->name,
+           (unsigned long)sim->particlecount,
+           mean,
+           1e9 / mean,
+           samples[ticks / 2],
+           samples[ticks * 9 / 10],
+           samples[ticks * 99 / 100],
+           samples[ticks - 1],
+           sorttotal * 1000.0 / ticks,
+           rest,
+           particle_hash(sim)
+           );
+#if SIM_STATS
+    printf("%-20s %-8s moved %.1f, walls %.1f, collisions %.1f, diagonals %.1f, clamps %.1f, sortmoves %.1f\n",
+           "", "",
+           (double)statstotal.moved / ticks,
+           (double)statstotal.walls / ticks,
+           (double)statstotal.collisions / ticks,
+           (double)statstotal.diagonals / ticks,
+           (double)statstotal.clamps / ticks,
+           (double)statstotal.sortmoves / ticks
+           );
+#endif
+
+    uint32_t hash = particle_hash(sim);
+    delete sim;
+    return hash;
+}
+
+template<class Sand>
+static void run_sand_bench(const bench_world_t* world, const tilt_script_t* script, uint32_t ticks) {
+    Sand* sand = new Sand(MPU_SCALE);
+
+    // Same as start_stage() in particlesim.cpp
+    sand->clearAll();
+    sand->loadBackground(world->bg);
+    sand->loadParticles(world->particles, world->particlecount);
+
+    sand->scale = world->scale;
+
+    std::vector<uint32_t> samples(ticks);
+    uint64_t total = 0;
+
+    for (uint32_t t = 0; t < ticks; ++t) {
+        tilt_t a = script->func(t);
+
+        auto ts = std::chrono::steady_clock::now();
+        sand->iterate((int) (a.x * PHYSICS_PRESCALE), (int) (a.y * PHYSICS_PRESCALE),
+                      (int) (a.z * PHYSICS_PRESCALE));
+        auto te = std::chrono::steady_clock::now();
+
+        samples[t] = (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(te - ts).count();
+        total += samples[t];
+    }
+
+    std::sort(samples.begin(), samples.end());
+
+    double mean = (double)total / ticks;
+    printf("%-20s %-8s %5lu %9.0f %10.0f %9u %9u %9u %9u %9.0f %5.1f  %08x\n",
+           world->name,
+           script->name,
+           (unsigned long)sand->particlecount,
+           mean,
+           1e9 / mean,
+           samples[ticks / 2],
+           samples[ticks * 9 / 10],
+           samples[ticks * 99 / 100],
+           samples[ticks - 1],
+           0.0,
+           0.0,
+           grain_hash(sand)
+           );
+
+    delete sand;
+}
+
+static uint32_t run_world(const bench_world_t* world, const tilt_script_t* script, uint32_t ticks, SIM_SORTMODE sortmode,
+                          bool activeset, worksplit_t* split) {
+    // Pick the matching instantiation of the simulation, returns the hash of particle simulations
+    if (world->engine == STAGE_ENGINE_SAND) {
+        if (world->w == DISPLAY_WIDTH && world->h == DISPLAY_HEIGHT) {
+            run_sand_bench<Sand<DISPLAY_WIDTH, DISPLAY_HEIGHT>>(world, script, ticks);
+        } else if (world->w == 64 && world->h == 64) {
+            run_sand_bench<Sand<64, 64>>(world, script, ticks);
+        } else {
+            panic("No sand engine for %lux%lu worlds\n", (unsigned long)world->w, (unsigned long)world->h);
+        }
+        return 0;
+    } else if (world->w == DISPLAY_WIDTH && world->h == DISPLAY_HEIGHT) {
+        // Same as the firmware
+        return run_bench<Simulation<DISPLAY_WIDTH, DISPLAY_HEIGHT, SIM_MAX_PARTICLECOUNT>>(world, script, ticks, sortmode, activeset, split);
+    } else if (world->w == 64 && world->h == 32) {
+        return run_bench<Simulation<64, 32>>(world, script, ticks, sortmode, activeset, split);
+    } else if (world->w == 64 && world->h == 64) {
+        return run_bench<Simulation<64, 64>>(world, script, ticks, sortmode, activeset, split);
+    } else {
+        panic("No simulation for %lux%lu worlds\n", (unsigned long)world->w, (unsigned long)world->h);
+    }
+}
+
+int main(int argc, char** argv) {
+    uint32_t ticks = BENCH_DEFAULT_TICKS;
+    const char* stage_filter = "";
+    const char* script_filter = "";
+    int sortmode = SIM_SORTMODE_INCREMENTAL;
+    bool activeset = true;
+    bool jitter = true;
+    bool helper = false;
+    uint32_t speed = 0;
+    bool check = false;
+    int mismatches = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        if (i + 1 < argc && strcmp(argv[i], "-t") == 0) {
+            ticks = strtoul(argv[++i], nullptr, 0);
+        } else if (i + 1 < argc && strcmp(argv[i], "-s") == 0) {
+            stage_filter = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "-i") == 0) {
+            script_filter = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "-m") == 0) {
+            ++i;
+            sortmode = -1;
+            for (int m = 0; m < count_of(sortmode_names); ++m) {
+                if (strcmp(argv[i], sortmode_names[m]) == 0) {
+                    sortmode = m;
+                }
+            }
+            if (sortmode == -1) {
+                fprintf(stderr, "Unknown sort mode '%s'\n", argv[i]);
+                return 2;
+            }
+        } else if (i + 1 < argc && strcmp(argv[i], "-v") == 0) {
+            speed = strtoul(argv[++i], nullptr, 0);
+            if (speed < 1 || speed > SIM_MAX_SPEED) {
+                fprintf(stderr, "Speed must be between 1 and %d\n", SIM_MAX_SPEED);
+                return 2;
+            }
+        } else if (strcmp(argv[i], "-A") == 0) {
+            activeset = false;
+        } else if (strcmp(argv[i], "-R") == 0) {
+            jitter = false;
+        } else if (strcmp(argv[i], "-2") == 0) {
+            helper = true;
+        } else if (strcmp(argv[i], "-C") == 0) {
+            check = true;
+        } else {
+            fprintf(stderr, "Usage: %s [-t ticks] [-s stage] [-i script] [-m sortmode] [-v speed] [-A] [-R] [-2] [-C]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if (ticks == 0) {
+        fprintf(stderr, "Tick count must be at least 1\n");
+        return 2;
+    }
+
+    printf("%-20s %-8s %5s %9s %10s %9s %9s %9s %9s %9s %5s  %-8s\n",
+           "stage", "script", "parts", "ns/tick", "ticks/s", "p50", "p90", "p99", "max", "sort", "rest", "hash");
+
+    // Second thread doing the same as core1 does in its stall windows
+    worksplit_t split;
+    worksplit_t* splitptr = nullptr;
+    std::atomic<bool> helperstop(false);
+    std::thread helperthread;
+    if (helper) {
+        worksplit_init(&split);
+        splitptr = &split;
+        helperthread = std::thread([&split, &helperstop]() {
+            while (!helperstop.load()) {
+                if (!worksplit_help(&split)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<bench_world_t> worlds;
+    for (int i = 0; i < count_of(stages); ++i) {
+        worlds.push_back({
+            strstr(stage_names[i], ": ") + 2,
+            stages[i].engine,
+            DISPLAY_WIDTH, DISPLAY_HEIGHT,
+            stages[i].bg,
+            stages[i].particles,
+            stages[i].particlecount,
+            stages[i].scale,
+            stages[i].elasticity,
+            stages[i].rand,
+            stages[i].speed,
+        });
+    }
+
+    // Larger worlds, e.g. chained panels
+    worlds.emplace_back();
+    generate_world(&worlds.back(), "GENERATED64X32", STAGE_ENGINE_PARTICLES, 64, 32, 64*32/2);
+    worlds.emplace_back();
+    generate_world(&worlds.back(), "GENERATED64X64", STAGE_ENGINE_PARTICLES, 64, 64, 64*64/2);
+
+    // Sand, three quarters full and completely full
+    worlds.emplace_back();
+    generate_world(&worlds.back(), "SAND32X32", STAGE_ENGINE_SAND, 32, 32, 32*32*3/4);
+    worlds.emplace_back();
+    generate_world(&worlds.back(), "SANDFULL32X32", STAGE_ENGINE_SAND, 32, 32, 32*32);
+    worlds.emplace_back();
+    generate_world(&worlds.back(), "SAND64X64", STAGE_ENGINE_SAND, 64, 64, 64*64*3/4);
+
+    for (const bench_world_t& world : worlds) {
+        if (strstr(world.name, stage_filter) == nullptr) {
+            continue;
+        }
+        bench_world_t w = world;
+        w.rand = world.rand && jitter;
+        if (speed != 0) {
+            w.speed = speed;
+        }
+        for (const tilt_script_t& script : scripts) {
+            if (strstr(script.name, script_filter) == nullptr) {
+                continue;
+            }
+            uint32_t hash = run_world(&w, &script, ticks, (SIM_SORTMODE) sortmode, activeset, splitptr);
+            if (check && w.engine == STAGE_ENGINE_PARTICLES) {
+                uint32_t expected = run_world(&w, &script, ticks, (SIM_SORTMODE) sortmode, false, nullptr);
+                if (hash != expected) {
+                    printf("%-20s %-8s MISMATCH, %08x without skipping\n", w.name, script.name, expected);
+                    ++mismatches;
+                }
+            }
+        }
+    }
+
+    if (helper) {
+        helperstop = true;
+        helperthread.join();
+        printf("Helper thread did %llu of %llu velocity chunks\n",
+               (unsigned long long)bench_split_helped, (unsigned long long)bench_split_chunks);
+    }
+
+    if (mismatches != 0) {
+        fprintf(stderr, "%d runs changed by skipping resting particles\n", mismatches);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,364 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "hub75_chain.h"
+
+/*
+ * Host model of the self-running DMA refresh, see hub75_chain.cpp
+ *
+ * Builds the chains with hub75_chain_build() on a fake address space and runs them on
+ * a model of the RP2040 DMA: the channel registers and their trigger aliases, transfer
+ * count reloads, increments, write rings and chaining, decoded from the CTRL values as
+ * the hardware does. The TX FIFOs of the SMs just record what they are given, pacing
+ * only changes the timing, not the order.
+ *
+ * For every frame, the data SM has to receive all bitplanes of the shown buffer in
+ * row and bit order, and the row SM the row word after each of them. The row words are
+ * restaged right after the restart in some frames, like hub75_main() does after a flip,
+ * and have to take effect with the next frame. The buffer is
+ * flipped at a random point in some frames, the flip has to take effect with the
+ * next frame, not in the middle of the current one. hub75_chain_contains() must not
+ * report a chain as shown before the restart has loaded it.
+ *
+ * Usage: particlesim_dmachain [-f frames] [-S seed]
+ */
+
+#define MODEL_DEFAULT_FRAMES 100
+#define MODEL_DEFAULT_SEED 1
+
+// Bounds a frame, a broken chain should fail instead of running forever
+#define MODEL_MAX_TRANSFERS (DISPLAY_CHAIN_BLOCKS*(4 + DISPLAY_PLANE_WORDS) + DISPLAY_SCAN*DISPLAY_BITDEPTH + 16)
+
+// Fake address space, laid out like the RP2040
+#define MODEL_RAM_BASE 0x20000000u
+#define MODEL_DMA_BASE 0x50000000u
+#define MODEL_PIO_TXF  0x50200010u
+
+// Channel register offsets
+#define MODEL_DMA_CH_STRIDE 0x40u
+#define MODEL_DMA_READ_ADDR 0x00u
+#define MODEL_DMA_WRITE_ADDR 0x04u
+#define MODEL_DMA_TRANS_COUNT 0x08u
+#define MODEL_DMA_CTRL_TRIG 0x0Cu
+#define MODEL_DMA_AL3_READ_ADDR_TRIG 0x3Cu
+
+// CTRL register fields
+#define MODEL_CTRL_EN (1u << 0)
+#define MODEL_CTRL_DATA_SIZE_32 (2u << 2)
+#define MODEL_CTRL_INCR_READ (1u << 4)
+#define MODEL_CTRL_INCR_WRITE (1u << 5)
+#define MODEL_CTRL_RING_SIZE(x) ((x) << 6)
+#define MODEL_CTRL_RING_SEL (1u << 10)
+#define MODEL_CTRL_CHAIN_TO(x) ((x) << 11)
+#define MODEL_CTRL_TREQ(x) ((x) << 15)
+#define MODEL_TREQ_FORCE 0x3Fu
+
+// Channels and SMs, as claimed on the device
+#define MODEL_CHAN_EXEC 0
+#define MODEL_CHAN_CTRL 1
+#define MODEL_SM_DATA 0
+#define MODEL_SM_ROW 1
+
+typedef struct model_channel {
+    uint32_t read_addr, write_addr;
+    uint32_t trans_count;  // Reload value, as last written
+    uint32_t remaining;
+    uint32_t ctrl;
+    bool busy;
+} model_channel_t;
+
+typedef struct model_push {
+    int sm;
+    uint32_t value;
+} model_push_t;
+
+static std::vector<uint32_t> model_ram;
+static model_channel_t model_chan[2];
+static std::vector<model_push_t> model_pushes;
+static bool model_fault;
+static uint32_t model_restarts;
+static uint32_t model_loaded;  // Chain the last restart loaded
+
+static uint32_t model_random(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static uint32_t* model_ram_word(uint32_t addr) {
+    if (addr < MODEL_RAM_BASE || (addr & 3) || (addr - MODEL_RAM_BASE)/4 >= model_ram.size()) {
+        return nullptr;
+    }
+    return &model_ram[(addr - MODEL_RAM_BASE)/4];
+}
+
+static uint32_t model_dma_reg(int ch, uint32_t reg) {
+    return MODEL_DMA_BASE + ch*MODEL_DMA_CH_STRIDE + reg;
+}
+
+static void model_trigger(int ch) {
+    model_channel_t& c = model_chan[ch];
+    if (c.ctrl & MODEL_CTRL_EN) {
+        c.remaining = c.trans_count;
+        c.busy = c.remaining > 0;
+    }
+}
+
+static uint32_t model_read(uint32_t addr) {
+    uint32_t* p = model_ram_word(addr);
+    if (p == nullptr) {
+        printf("FAIL read from 0x%08x\n", addr);
+        model_fault = true;
+        return 0;
+    }
+    return *p;
+}
+
+static void model_write(uint32_t addr, uint32_t value) {
+    if (uint32_t* p = model_ram_word(addr)) {
+        *p = value;
+        return;
+    }
+    for (int sm : {MODEL_SM_DATA, MODEL_SM_ROW}) {
+        if (addr == MODEL_PIO_TXF + 4*sm) {
+            model_pushes.push_back({sm, value});
+            return;
+        }
+    }
+    for (int ch = 0; ch < 2; ++ch) {
+        model_channel_t& c = model_chan[ch];
+        if (addr == model_dma_reg(ch, MODEL_DMA_READ_ADDR)) {
+            c.read_addr = value;
+            return;
+        } else if (addr == model_dma_reg(ch, MODEL_DMA_WRITE_ADDR)) {
+            c.write_addr = value;
+            return;
+        } else if (addr == model_dma_reg(ch, MODEL_DMA_TRANS_COUNT)) {
+            c.trans_count = value;
+            return;
+        } else if (addr == model_dma_reg(ch, MODEL_DMA_CTRL_TRIG)) {
+            c.ctrl = value;
+            model_trigger(ch);
+            return;
+        } else if (addr == model_dma_reg(ch, MODEL_DMA_AL3_READ_ADDR_TRIG)) {
+            c.read_addr = value;
+            if (ch == MODEL_CHAN_CTRL) {
+                model_restarts++;
+                model_loaded = value;
+            }
+            model_trigger(ch);
+            return;
+        }
+    }
+    printf("FAIL write of 0x%08x to 0x%08x\n", value, addr);
+    model_fault = true;
+}
+
+static uint32_t model_advance(uint32_t addr, bool incr, bool ring, uint32_t ring_size) {
+    if (!incr) {
+        return addr;
+    }
+    if (ring && ring_size > 0) {
+        uint32_t mask = (1u << ring_size) - 1;
+        return (addr & ~mask) | ((addr + 4) & mask);
+    }
+    return addr + 4;
+}
+
+// One transfer of a busy channel, false once nothing is busy anymore
+static bool model_step() {
+    for (int ch = 0; ch < 2; ++ch) {
+        model_channel_t& c = model_chan[ch];
+        if (!c.busy) {
+            continue;
+        }
+        if ((c.ctrl & (3u << 2)) != MODEL_CTRL_DATA_SIZE_32) {
+            printf("FAIL channel %d is not using 32-bit transfers\n", ch);
+            model_fault = true;
+            return false;
+        }
+
+        model_write(c.write_addr, model_read(c.read_addr));
+
+        uint32_t ring_size = (c.ctrl >> 6) & 0xF;
+        bool ring_write = c.ctrl & MODEL_CTRL_RING_SEL;
+        c.read_addr = model_advance(c.read_addr, c.ctrl & MODEL_CTRL_INCR_READ, !ring_write, ring_size);
+        c.write_addr = model_advance(c.write_addr, c.ctrl & MODEL_CTRL_INCR_WRITE, ring_write, ring_size);
+
+        if (--c.remaining == 0) {
+            c.busy = false;
+            int chain_to = (c.ctrl >> 11) & 0xF;
+            if (chain_to != ch) {
+                model_trigger(chain_to);
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+int main(int argc, char** argv) {
+    uint32_t frames = MODEL_DEFAULT_FRAMES;
+    uint32_t seed = MODEL_DEFAULT_SEED;
+
+    for (int i = 1; i < argc; ++i) {
+        if (i + 1 < argc && strcmp(argv[i], "-f") == 0) {
+            frames = strtoul(argv[++i], nullptr, 0);
+        } else if (i + 1 < argc && strcmp(argv[i], "-S") == 0) {
+            seed = strtoul(argv[++i], nullptr, 0);
+        } else {
+            fprintf(stderr, "Usage: %s [-f frames] [-S seed]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (seed == 0) {
+        seed = 1;
+    }
+
+    // RAM: both bitplane buffers, the live and staged row words, the next pointer and both chains
+    const uint32_t plane_words = sizeof(display_planes_t)/4;
+    const uint32_t row_words = DISPLAY_SCAN*DISPLAY_BITDEPTH;
+    const uint32_t chain_words = DISPLAY_CHAIN_STRIDE*4;
+    const uint32_t planes_addr[2] = {MODEL_RAM_BASE, MODEL_RAM_BASE + 4*plane_words};
+    const uint32_t rowwords_addr = MODEL_RAM_BASE + 8*plane_words;
+    const uint32_t staged_addr = rowwords_addr + 4*row_words;
+    const uint32_t next_addr = staged_addr + 4*row_words;
+    const uint32_t chain_addr[2] = {next_addr + 4, next_addr + 4 + 4*chain_words};
+    model_ram.assign(2*plane_words + 2*row_words + 1 + 2*chain_words, 0);
+
+    // Distinct contents, so that every word can be told apart
+    for (uint32_t i = 0; i < plane_words; ++i) {
+        *model_ram_word(planes_addr[0] + 4*i) = 0xA0000000u | i;
+        *model_ram_word(planes_addr[1] + 4*i) = 0xB0000000u | i;
+    }
+    // Staged and live row words start out the same, like in hub75_chain_start()
+    // Each restaging gets its own generation in bits 16 and up
+    uint32_t generation = 0;
+    for (uint32_t i = 0; i < row_words; ++i) {
+        *model_ram_word(rowwords_addr + 4*i) = 0xC0000000u | i;
+        *model_ram_word(staged_addr + 4*i) = 0xC0000000u | i;
+    }
+
+    // Same channel setup as hub75_chain_init()
+    uint32_t ctrl_ctrl = MODEL_CTRL_EN | MODEL_CTRL_DATA_SIZE_32 | MODEL_CTRL_INCR_READ | MODEL_CTRL_INCR_WRITE
+                         | MODEL_CTRL_RING_SIZE(4) | MODEL_CTRL_RING_SEL
+                         | MODEL_CTRL_CHAIN_TO(MODEL_CHAN_CTRL) | MODEL_CTRL_TREQ(MODEL_TREQ_FORCE);
+    uint32_t exec_base = MODEL_CTRL_EN | MODEL_CTRL_DATA_SIZE_32 | MODEL_CTRL_INCR_READ
+                         | MODEL_CTRL_CHAIN_TO(MODEL_CHAN_CTRL);
+    // DREQ_PIO0_TX0 is 0
+    uint32_t data_ctrl = exec_base | MODEL_CTRL_TREQ(MODEL_SM_DATA);
+    uint32_t row_ctrl = exec_base | MODEL_CTRL_TREQ(MODEL_SM_ROW);
+    uint32_t copy_ctrl = exec_base | MODEL_CTRL_INCR_WRITE | MODEL_CTRL_TREQ(MODEL_TREQ_FORCE);
+    uint32_t restart_ctrl = MODEL_CTRL_EN | MODEL_CTRL_DATA_SIZE_32
+                            | MODEL_CTRL_CHAIN_TO(MODEL_CHAN_EXEC) | MODEL_CTRL_TREQ(MODEL_TREQ_FORCE);
+
+    for (int i = 0; i < 2; ++i) {
+        hub75_chain_config_t config = {
+                .planes = planes_addr[i],
+                .rowwords = rowwords_addr,
+                .staged = staged_addr,
+                .data_txf = MODEL_PIO_TXF + 4*MODEL_SM_DATA,
+                .row_txf = MODEL_PIO_TXF + 4*MODEL_SM_ROW,
+                .data_ctrl = data_ctrl,
+                .row_ctrl = row_ctrl,
+                .copy_ctrl = copy_ctrl,
+                .restart_ctrl = restart_ctrl,
+                .next = next_addr,
+                .restart = model_dma_reg(MODEL_CHAN_CTRL, MODEL_DMA_AL3_READ_ADDR_TRIG),
+        };
+        std::vector<hub75_chain_block_t> blocks(DISPLAY_CHAIN_BLOCKS);
+        hub75_chain_build(blocks.data(), &config);
+        memcpy(model_ram_word(chain_addr[i]), blocks.data(), sizeof(hub75_chain_block_t)*blocks.size());
+    }
+
+    model_chan[MODEL_CHAN_CTRL] = {0, model_dma_reg(MODEL_CHAN_EXEC, MODEL_DMA_READ_ADDR), 4, 0, ctrl_ctrl, false};
+    model_chan[MODEL_CHAN_EXEC] = {0, MODEL_PIO_TXF, DISPLAY_PLANE_WORDS, 0, 0, false};
+
+    // Start, like hub75_chain_start()
+    int shown = 0;
+    *model_ram_word(next_addr) = chain_addr[shown];
+    model_write(model_dma_reg(MODEL_CHAN_CTRL, MODEL_DMA_AL3_READ_ADDR_TRIG), chain_addr[shown]);
+
+    uint32_t flips = 0;
+    for (uint32_t f = 0; f < frames && !model_fault; ++f) {
+        model_pushes.clear();
+        bool flip = model_random(seed) % 3 == 0;
+        uint32_t flip_at = model_random(seed) % (DISPLAY_CHAIN_BLOCKS*4);
+
+        // The restart was just now, so this frame still has to use the previous row words
+        uint32_t rowgen = generation;
+        if (model_random(seed) % 4 == 0) {
+            generation = (generation + 1) & 0xFFF;
+            for (uint32_t i = 0; i < row_words; ++i) {
+                *model_ram_word(staged_addr + 4*i) = 0xC0000000u | generation << 16 | i;
+            }
+        }
+
+        uint32_t transfers = 0;
+        uint32_t restarts = model_restarts;
+        while (!model_fault) {
+            if (flip && transfers == flip_at) {
+                *model_ram_word(next_addr) = chain_addr[!shown];
+            }
+            if (!model_step()) {
+                printf("FAIL chain stopped in frame %u\n", f);
+                return 1;
+            }
+            // Like hub75_chain_showing(), which must not report a chain before it was loaded
+            for (int i = 0; i < 2; ++i) {
+                if (hub75_chain_contains(chain_addr[i], model_chan[MODEL_CHAN_CTRL].read_addr) &&
+                        model_loaded != chain_addr[i]) {
+                    printf("FAIL chain %d reported as shown in frame %u before it was loaded\n", i, f);
+                    return 1;
+                }
+            }
+            if (++transfers > MODEL_MAX_TRANSFERS) {
+                printf("FAIL frame %u did not end\n", f);
+                return 1;
+            }
+
+            // Only the restart itself ends a frame
+            if (model_restarts != restarts) {
+                break;
+            }
+        }
+        if (model_fault) {
+            break;
+        }
+
+        // Everything of this frame came from the buffer that was shown when it started
+        size_t k = 0;
+        bool ok = model_pushes.size() == (size_t)row_words*(DISPLAY_PLANE_WORDS + 1);
+        for (uint32_t p = 0; ok && p < row_words; ++p) {
+            for (uint32_t w = 0; ok && w < DISPLAY_PLANE_WORDS; ++w, ++k) {
+                uint32_t expected = (shown ? 0xB0000000u : 0xA0000000u) | (p*DISPLAY_PLANE_WORDS + w);
+                ok = model_pushes[k].sm == MODEL_SM_DATA && model_pushes[k].value == expected;
+            }
+            ok = ok && model_pushes[k].sm == MODEL_SM_ROW && model_pushes[k].value == (0xC0000000u | rowgen << 16 | p);
+            ++k;
+        }
+        if (!ok) {
+            printf("FAIL frame %u pushed %zu words, mismatch at %zu\n", f, model_pushes.size(), k);
+            return 1;
+        }
+
+        // The next frame has to start with the flipped buffer
+        uint32_t ctrl_read = model_chan[MODEL_CHAN_CTRL].read_addr;
+        int next = (ctrl_read == chain_addr[1]);
+        if (next != (flip ? !shown : shown)) {
+            printf("FAIL frame %u flip to %d was not picked up at the end of the frame\n", f, !shown);
+            return 1;
+        }
+        flips += (next != shown);
+        shown = next;
+    }
+    if (model_fault) {
+        return 1;
+    }
+
+    printf("%u frames of %u blocks, %u flips OK\n", frames, DISPLAY_CHAIN_BLOCKS, flips);
+    return 0;
+}
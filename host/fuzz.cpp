@@ -0,0 +1,569 @@
+#include <vector>
+
+#include "particlesim.h"
+#include "simulation.h"
+#include "sand.h"
+
+/*
+ * Host fuzz harness for Simulation
+ *
+ * Generates random worlds (obstacles, particles, colors) and drives the simulation
+ * with random accelerometer sequences and random settings, including the speed limit. After every tick, the
+ * following invariants are checked:
+ *
+ * - Every particle is within the world and not on an obstacle
+ * - No two particles share a cell
+ * - The bitmap has exactly one bit set for every particle, apart from the obstacles
+ * - The cells published for the display match the particle positions, also right after loading
+ * - With SIM_INDEX_GRID, the grid holds the index of every particle and nothing else
+ * - Positions and velocities match those of an oracle run with the same inputs and
+ *   activeset off, so skipping resting particles does not change the results
+ *
+ * Before the runs, sim_octant() is checked against the atan2() based octant it replaced,
+ * exhaustively for all inputs up to FUZZ_OCTANT_RANGE, well beyond what the
+ * accelerometer delivers after scaling.
+ * sim_diag_table is checked against the branches it replaced, copied unchanged from
+ * the simulation, for every velocity up to one cell per axis and all neighbour states.
+ *
+ * Sand runs the same way on random worlds filled up to every free cell. After every
+ * tick, the grain count, the obstacles, the colors and the published cells are checked
+ * against the grain bitmap, see check_sand().
+ *
+ * Usage: particlesim_fuzz [-n runs] [-t ticks] [-S seed]
+ *
+ * Every run uses its own seed, derived from -S and the run number. A failing run
+ * prints its seed, it can be repeated with -n 1 -S <seed>.
+ */
+
+// Normally defined in particlesim.cpp, referenced by anim_helpers.cpp
+uint32_t anim_framebuf[DISPLAY_HEIGHT*DISPLAY_WIDTH];
+
+#define FUZZ_DEFAULT_RUNS 200
+#define FUZZ_DEFAULT_TICKS 2000
+#define FUZZ_DEFAULT_SEED 1
+
+#define FUZZ_OCTANT_RANGE 4096
+
+// Elasticities the diagonal collisions are checked with
+static const uint8_t fuzz_diag_elasticities[] = {0, SIM_ELASTICITY, 255};
+
+// Random number generator of the harness, independent of the simulation
+static uint32_t fuzz_random(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static uint32_t fuzz_range(uint32_t& state, uint32_t n) {
+    return fuzz_random(state) % n;
+}
+
+static int8_t octant_reference(int32_t ax, int32_t ay) {
+    // Octant as previously computed in Simulation::iterate(), from Adafruit_PixelDust
+    int8_t q;
+    q = (int)(atan2(ay, ax) * 8.0 / M_PI); // -8 to +8
+    if (q >= 0)
+        q = (q + 1) / 2;
+    else
+        q = (q + 16) / 2;
+    if (q > 7)
+        q = 7;
+    return q;
+}
+
+static bool check_octants() {
+    for (int32_t ay = -FUZZ_OCTANT_RANGE; ay <= FUZZ_OCTANT_RANGE; ++ay) {
+        for (int32_t ax = -FUZZ_OCTANT_RANGE; ax <= FUZZ_OCTANT_RANGE; ++ax) {
+            if (sim_octant(ax, ay) != octant_reference(ax, ay)) {
+                printf("FAIL octant of ax=%d ay=%d is %d instead of %d\n", ax, ay, sim_octant(ax, ay),
+                       octant_reference(ax, ay));
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Occupancy around a particle in the middle cell, for the diagonal collision checks
+static bool diag_cells[3][3];
+
+// Stands in for Simulation::getPixel(), so the copied branches below compile unchanged
+static bool getPixel(uint32_t x, uint32_t y) {
+    return diag_cells[y][x];
+}
+
+static void diag_reference(particle_pos_t* positions, particle_vel_t* velocities, int32_t& newx, int32_t& newy,
+                           uint8_t elasticity) {
+    // Diagonal collision as previously resolved in Simulation::iterate(), before sim_diag_table
+    // The branches are copied unchanged apart from their indentation
+    int i = 0;
+    // Diagonal collision, should be quite rare
+    // Try to skid along the "wall" with the faster axis first
+    if (abs(velocities[i].vx) >= abs(velocities[i].vy)) {
+        // X is faster (or equal)
+        if (!getPixel(newx/256, positions[i].y/256)) {
+            // Neighbour in x direction is free, take it and bounce y
+            newy = positions[i].y;
+            BOUNCE(velocities[i].vy);
+        } else {
+            // Check if y is free
+            if (!getPixel(positions[i].x/256, newy/256)) {
+                // Neighbour in y direction is free, take it and bounce x
+                newx = positions[i].x;
+                BOUNCE(velocities[i].vx);
+            } else {
+                // Nope, both occupied. Bounce x and y
+                newx = positions[i].x;
+                newy = positions[i].y;
+                BOUNCE(velocities[i].vx);
+                BOUNCE(velocities[i].vy);
+            }
+        }
+    } else {
+        // Y is faster
+        if (!getPixel(positions[i].x/256, newy/256)) {
+            // Neighbour in y direction is free, take it and bounce x
+            newx = positions[i].x;
+            BOUNCE(velocities[i].vx);
+        } else {
+            // Check if x is free
+            if (!getPixel(newx/256, positions[i].y/256)) {
+                // Neighbour in x direction is free, take it and bounce y
+                newy = positions[i].y;
+                BOUNCE(velocities[i].vy);
+            } else {
+                // Nope, both occupied. Bounce x and y
+                newx = positions[i].x;
+                newy = positions[i].y;
+                BOUNCE(velocities[i].vx);
+                BOUNCE(velocities[i].vy);
+            }
+        }
+    }
+}
+
+static void diag_table(particle_pos_t* positions, particle_vel_t* velocities, int32_t& newx, int32_t& newy,
+                       uint8_t elasticity) {
+    // Same as Simulation::iterate()
+    int i = 0;
+    uint32_t k = SIM_DIAG_TARGET;
+    k |= getPixel(newx/256, positions[i].y/256) ? SIM_DIAG_XNEIGH : 0;
+    k |= getPixel(positions[i].x/256, newy/256) ? SIM_DIAG_YNEIGH : 0;
+    k |= abs(velocities[i].vx) >= abs(velocities[i].vy) ? SIM_DIAG_XFASTER : 0;
+
+    uint8_t keep = sim_diag_table[k];
+    if (!(keep & SIM_KEEP_X)) {
+        newx = positions[i].x;
+        BOUNCE(velocities[i].vx);
+    }
+    if (!(keep & SIM_KEEP_Y)) {
+        newy = positions[i].y;
+        BOUNCE(velocities[i].vy);
+    }
+}
+
+static bool check_diagonals() {
+    // Particle somewhere in cell (1, 1), moving into an occupied diagonal neighbour
+    static const uint16_t subcells[] = {0, 1, 128, 254, 255};
+    for (uint32_t n = 0; n < 4; ++n) {
+        for (uint8_t e : fuzz_diag_elasticities) {
+            for (uint16_t sy : subcells) {
+                for (uint16_t sx : subcells) {
+                    for (int32_t vy = -256; vy <= 256; ++vy) {
+                        for (int32_t vx = -256; vx <= 256; ++vx) {
+                            particle_pos_t pos = {(uint16_t)(256 + sx), (uint16_t)(256 + sy)};
+                            int32_t tx = (pos.x + vx)/256, ty = (pos.y + vy)/256;
+                            if (tx == 1 || ty == 1) {
+                                continue;
+                            }
+
+                            memset(diag_cells, 0, sizeof(diag_cells));
+                            diag_cells[ty][tx] = true;
+                            diag_cells[1][tx] = n & 1;
+                            diag_cells[ty][1] = n & 2;
+
+                            particle_vel_t refvel = {(int16_t)vx, (int16_t)vy}, vel = refvel;
+                            int32_t refx = pos.x + vx, refy = pos.y + vy;
+                            int32_t newx = refx, newy = refy;
+                            diag_reference(&pos, &refvel, refx, refy, e);
+                            diag_table(&pos, &vel, newx, newy, e);
+                            if (newx != refx || newy != refy || vel.vx != refvel.vx || vel.vy != refvel.vy) {
+                                printf("FAIL diagonal from %u,%u with v=%d,%d and neighbours %u differs\n",
+                                       pos.x, pos.y, vx, vy, n);
+                                return false;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+template<class Sim>
+static bool check_invariants(const Sim* sim, const uint32_t* bg, const particle_cell_t* cells,
+                             std::vector<uint8_t>& owner, const char** failure) {
+    constexpr uint32_t w = Sim::width, h = Sim::height;
+
+    std::fill(owner.begin(), owner.end(), 0);
+    for (uint32_t i = 0; i < sim->particlecount; ++i) {
+        uint32_t x = sim->positions[i].x, y = sim->positions[i].y;
+        if (x > w*256-1 || y > h*256-1) {
+            *failure = "particle out of bounds";
+            return false;
+        }
+
+        uint32_t cx = x/256, cy = y/256;
+        if (bg[cy*w + cx] != 0) {
+            *failure = "particle on an obstacle";
+            return false;
+        }
+        if (owner[cy*w + cx]) {
+            *failure = "two particles share a cell";
+            return false;
+        }
+        owner[cy*w + cx] = 1;
+
+#if SIM_INDEX_GRID
+        if (sim->particleAt(cx, cy) != i) {
+            *failure = "index grid does not point to the particle";
+            return false;
+        }
+#endif
+
+        if (cells[i].x != cx || cells[i].y != cy || cells[i].color != sim->colors[i]) {
+            *failure = "published cell does not match the particle";
+            return false;
+        }
+    }
+
+    uint32_t bits = 0;
+    for (uint32_t y = 0; y < h; ++y) {
+        for (uint32_t x = 0; x < w; ++x) {
+            bool set = sim->getPixel(x, y);
+#if SIM_INDEX_GRID
+            if (!owner[y*w + x] && sim->particleAt(x, y) != SIM_NO_PARTICLE) {
+                *failure = "index grid has a particle in an empty cell";
+                return false;
+            }
+#endif
+            if (bg[y*w + x] != 0) {
+                if (!set) {
+                    *failure = "obstacle missing from the bitmap";
+                    return false;
+                }
+                continue;
+            }
+            if (set != (owner[y*w + x] != 0)) {
+                *failure = set ? "bitmap has a cell without a particle" : "bitmap is missing a particle";
+                return false;
+            }
+            bits += set;
+        }
+    }
+    if (bits != sim->particlecount) {
+        *failure = "bitmap popcount differs from the particle count";
+        return false;
+    }
+
+    return true;
+}
+
+template<class Sim>
+static bool check_oracle(const Sim* sim, const Sim* oracle, const char** failure) {
+    // Both are sorted the same way, so particles can be compared by index
+    for (uint32_t i = 0; i < sim->particlecount; ++i) {
+        particle_pos_t pos;
+        particle_vel_t vel;
+        sim->exactState(i, pos, vel);
+        if (pos.x != oracle->positions[i].x || pos.y != oracle->positions[i].y) {
+            *failure = "position differs from the oracle";
+            return false;
+        }
+        if (vel.vx != oracle->velocities[i].vx || vel.vy != oracle->velocities[i].vy) {
+            *failure = "velocity differs from the oracle";
+            return false;
+        }
+    }
+    return true;
+}
+
+template<class Sim>
+static bool fuzz_run(uint32_t seed, uint32_t ticks) {
+    constexpr uint32_t w = Sim::width, h = Sim::height;
+    uint32_t rng = seed;
+
+    // Random obstacles, anything from an empty world to a dense maze
+    std::vector<uint32_t> bg(w*h);
+    uint32_t density = fuzz_range(rng, 40);
+    std::vector<uint32_t> free;
+    for (uint32_t i = 0; i < w*h; ++i) {
+        if (fuzz_range(rng, 100) < density) {
+            bg[i] = 0x00FFFFFF;
+        } else {
+            free.push_back(i);
+        }
+    }
+
+    // Random particles on free cells, up to the capacity of the simulation
+    uint32_t maxcount = std::min<uint32_t>(free.size(), Sim::maxParticles);
+    uint32_t count = maxcount > 0 ? fuzz_range(rng, maxcount+1) : 0;
+    uint32_t colorcount = 1 + fuzz_range(rng, 16);
+    std::vector<uint32_t> particles(count*3);
+    for (uint32_t i = 0; i < count; ++i) {
+        // Partial Fisher-Yates shuffle
+        uint32_t j = i + fuzz_range(rng, free.size() - i);
+        std::swap(free[i], free[j]);
+        particles[i*3] = free[i] % w;
+        particles[i*3+1] = free[i] / w;
+        particles[i*3+2] = 1 + fuzz_range(rng, colorcount);
+    }
+
+    // The oracle runs every particle in every tick
+    Sim* sim = new Sim(MPU_SCALE, SIM_ELASTICITY, (SIM_SORTMODE) fuzz_range(rng, 3));
+    Sim* oracle = new Sim(MPU_SCALE, SIM_ELASTICITY, sim->sortmode);
+    uint32_t simseed = fuzz_random(rng);
+    for (Sim* s : {sim, oracle}) {
+        s->clearAll();
+        s->loadBackground(bg.data());
+        s->loadParticles(particles.data(), count);
+        s->seed(simseed);
+    }
+    sim->activeset = true;
+    oracle->activeset = false;
+
+    // Settings are changed every now and then during the run
+    int32_t ax = 0, ay = 0, az = 0;
+    std::vector<uint8_t> owner(w*h);
+    const char* failure = nullptr;
+    bool ok = check_invariants(sim, bg.data(), sim->publish(), owner, &failure);
+    if (!ok) {
+        printf("FAIL %ux%u seed=0x%08x after loading: %s\n", w, h, seed, failure);
+    }
+
+    for (uint32_t t = 0; t < ticks && ok; ++t) {
+        if (t % 256 == 0) {
+            sim->scale = oracle->scale = 1 + fuzz_range(rng, 255);
+            sim->elasticity = oracle->elasticity = fuzz_range(rng, 256);
+            sim->rand = oracle->rand = fuzz_range(rng, 2);
+            sim->speed = oracle->speed = 1 + fuzz_range(rng, SIM_MAX_SPEED);
+        }
+
+        // Mostly a slow random walk, sometimes a sudden jump or holding still,
+        // covering the inputs of the accelerometer beyond 1 g
+        uint32_t mode = fuzz_range(rng, 64);
+        if (mode == 0) {
+            ax = (int32_t)fuzz_range(rng, 257) - 128;
+            ay = (int32_t)fuzz_range(rng, 257) - 128;
+            az = (int32_t)fuzz_range(rng, 257) - 128;
+        } else if (mode < 48) {
+            ax = std::max(-128, std::min(128, ax + (int32_t)fuzz_range(rng, 9) - 4));
+            ay = std::max(-128, std::min(128, ay + (int32_t)fuzz_range(rng, 9) - 4));
+            az = std::max(-128, std::min(128, az + (int32_t)fuzz_range(rng, 9) - 4));
+        }
+
+        sim->iterate(ax, ay, az);
+        oracle->iterate(ax, ay, az);
+        ok = check_invariants(sim, bg.data(), sim->publish(), owner, &failure) &&
+                check_oracle(sim, oracle, &failure);
+        if (!ok) {
+            printf("FAIL %ux%u seed=0x%08x tick=%u: %s\n", w, h, seed, t, failure);
+        }
+    }
+
+    delete oracle;
+    delete sim;
+    return ok;
+}
+
+template<class Sand>
+static bool check_sand(const Sand* sand, const uint32_t* bg, const particle_cell_t* cells,
+                       const std::vector<uint32_t>& colorcounts, std::vector<uint32_t>& counts,
+                       std::vector<uint8_t>& listed, const char** failure) {
+    constexpr uint32_t w = Sand::width, h = Sand::height;
+
+    // Grains never leave the bitmap, never enter an obstacle and keep their colors
+    uint32_t bits = 0;
+    std::fill(counts.begin(), counts.end(), 0);
+    for (uint32_t y = 0; y < h; ++y) {
+        for (uint32_t x = 0; x < w; ++x) {
+            if (!sand->getPixel(x, y)) {
+                continue;
+            }
+            if (bg[y*w + x] != 0) {
+                *failure = "grain on an obstacle";
+                return false;
+            }
+            counts[sand->colors[y*w + x]]++;
+            bits++;
+        }
+    }
+    if (bits != sand->particlecount) {
+        *failure = "bitmap popcount differs from the grain count";
+        return false;
+    }
+    if (counts != colorcounts) {
+        *failure = "grain colors changed";
+        return false;
+    }
+
+    // The published cells are exactly the grains of the bitmap
+    std::fill(listed.begin(), listed.end(), 0);
+    for (uint32_t i = 0; i < sand->particlecount; ++i) {
+        uint32_t x = cells[i].x, y = cells[i].y;
+        if (x >= w || y >= h || !sand->getPixel(x, y)) {
+            *failure = "published cell without a grain";
+            return false;
+        }
+        if (listed[y*w + x]) {
+            *failure = "grain published twice";
+            return false;
+        }
+        listed[y*w + x] = 1;
+        if (cells[i].color != sand->colors[y*w + x]) {
+            *failure = "published color does not match the grain";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template<class Sand>
+static bool fuzz_sand_run(uint32_t seed, uint32_t ticks) {
+    constexpr uint32_t w = Sand::width, h = Sand::height;
+    uint32_t rng = seed;
+
+    // Random obstacles, same as fuzz_run()
+    std::vector<uint32_t> bg(w*h);
+    uint32_t density = fuzz_range(rng, 40);
+    std::vector<uint32_t> free;
+    for (uint32_t i = 0; i < w*h; ++i) {
+        if (fuzz_range(rng, 100) < density) {
+            bg[i] = 0x00FFFFFF;
+        } else {
+            free.push_back(i);
+        }
+    }
+
+    // Random grains, up to every free cell
+    uint32_t count = fuzz_range(rng, free.size()+1);
+    uint32_t colorcount = 1 + fuzz_range(rng, 16);
+    std::vector<uint32_t> particles(count*3);
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t j = i + fuzz_range(rng, free.size() - i);
+        std::swap(free[i], free[j]);
+        particles[i*3] = free[i] % w;
+        particles[i*3+1] = free[i] / w;
+        particles[i*3+2] = 1 + fuzz_range(rng, colorcount);
+    }
+
+    Sand* sand = new Sand(MPU_SCALE);
+    sand->clearAll();
+    sand->loadBackground(bg.data());
+    sand->loadParticles(particles.data(), count);
+
+    // Number of grains of every palette entry, which no tick may change
+    std::vector<uint32_t> colorcounts(SAND_MAX_COLORCOUNT), counts(SAND_MAX_COLORCOUNT);
+    for (uint32_t i = 0; i < count; ++i) {
+        colorcounts[sand->colors[particles[i*3+1]*w + particles[i*3]]]++;
+    }
+
+    std::vector<uint8_t> listed(w*h);
+    const char* failure = nullptr;
+    bool ok = check_sand(sand, bg.data(), sand->publish(), colorcounts, counts, listed, &failure);
+    if (!ok) {
+        printf("FAIL sand %ux%u seed=0x%08x after loading: %s\n", w, h, seed, failure);
+    }
+
+    // Random tilts, held for a while so the sand can settle, including none at all
+    int32_t ax = 0, ay = 0;
+    for (uint32_t t = 0; t < ticks && ok; ++t) {
+        if (t % 256 == 0) {
+            sand->scale = 1 + fuzz_range(rng, 255);
+        }
+        if (fuzz_range(rng, 32) == 0) {
+            ax = (int32_t)fuzz_range(rng, 257) - 128;
+            ay = (int32_t)fuzz_range(rng, 257) - 128;
+        }
+
+        sand->iterate(ax, ay, 0);
+        ok = check_sand(sand, bg.data(), sand->publish(), colorcounts, counts, listed, &failure);
+        if (!ok) {
+            printf("FAIL sand %ux%u seed=0x%08x tick=%u: %s\n", w, h, seed, t, failure);
+        }
+    }
+
+    delete sand;
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    uint32_t runs = FUZZ_DEFAULT_RUNS;
+    uint32_t ticks = FUZZ_DEFAULT_TICKS;
+    uint32_t seed = FUZZ_DEFAULT_SEED;
+
+    for (int i = 1; i < argc; ++i) {
+        if (i + 1 < argc && strcmp(argv[i], "-n") == 0) {
+            runs = strtoul(argv[++i], nullptr, 0);
+        } else if (i + 1 < argc && strcmp(argv[i], "-t") == 0) {
+            ticks = strtoul(argv[++i], nullptr, 0);
+        } else if (i + 1 < argc && strcmp(argv[i], "-S") == 0) {
+            seed = strtoul(argv[++i], nullptr, 0);
+        } else {
+            fprintf(stderr, "Usage: %s [-n runs] [-t ticks] [-S seed]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if (!check_octants() || !check_diagonals()) {
+        return 1;
+    }
+
+    uint32_t failed = 0;
+    for (uint32_t r = 0; r < runs; ++r) {
+        // Seed of this run, never zero since xorshift would get stuck
+        uint32_t s = seed + r*0x9E3779B9u;
+        if (s == 0) {
+            s = 1;
+        }
+
+        // Same geometries as the bench, plus one that is neither a power of two
+        // nor a multiple of 32 wide to cover the fallback paths
+        // Sand rows are whole words, so it gets one and several words per row
+        // Picked by the seed, so that a failing run can be repeated on its own
+        bool ok;
+        switch (s % 8) {
+            case 0:
+                ok = fuzz_run<Simulation<DISPLAY_WIDTH, DISPLAY_HEIGHT, SIM_MAX_PARTICLECOUNT>>(s, ticks);
+                break;
+            case 1:
+                ok = fuzz_run<Simulation<64, 32>>(s, ticks);
+                break;
+            case 2:
+                ok = fuzz_run<Simulation<64, 64>>(s, ticks);
+                break;
+            case 3:
+                ok = fuzz_run<Simulation<48, 20>>(s, ticks);
+                break;
+            case 4:
+                ok = fuzz_sand_run<Sand<32, 32>>(s, ticks);
+                break;
+            case 5:
+                ok = fuzz_sand_run<Sand<64, 32>>(s, ticks);
+                break;
+            case 6:
+                ok = fuzz_sand_run<Sand<96, 20>>(s, ticks);
+                break;
+            default:
+                ok = fuzz_sand_run<Sand<64, 64>>(s, ticks);
+                break;
+        }
+        failed += !ok;
+    }
+
+    printf("%u of %u runs failed\n", failed, runs);
+    return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+// Host shim for the interpolators, a software model of the features that are used:
+// shift, mask, sign extension and cross input. Results are computed when read,
+// like PEEK on the real hardware. Each thread has its own pair, like each core.
+
+#include "pico/stdlib.h"
+
+// Bits of the lane control registers, same as the hardware
+#define INTERP_SHIM_CTRL_SHIFT_LSB 0
+#define INTERP_SHIM_CTRL_MASK_LSB_LSB 5
+#define INTERP_SHIM_CTRL_MASK_MSB_LSB 10
+#define INTERP_SHIM_CTRL_SIGNED_BITS (1u << 15)
+#define INTERP_SHIM_CTRL_CROSS_INPUT_BITS (1u << 16)
+
+typedef struct {
+    uint32_t ctrl;
+} interp_config;
+
+typedef struct {
+    uint32_t accum[2];
+    uint32_t base[3];
+    uint32_t ctrl[2];
+} interp_hw_t;
+
+inline interp_hw_t* interp_shim_instance(uint num) {
+    static thread_local interp_hw_t interps[2];
+    return &interps[num];
+}
+
+#define interp0 (interp_shim_instance(0))
+#define interp1 (interp_shim_instance(1))
+
+static inline interp_config interp_default_config() {
+    // No shift, full mask, same as the SDK
+    interp_config c = {31u << INTERP_SHIM_CTRL_MASK_MSB_LSB};
+    return c;
+}
+
+static inline void interp_config_set_shift(interp_config* c, uint shift) {
+    c->ctrl = (c->ctrl & ~(0x1Fu << INTERP_SHIM_CTRL_SHIFT_LSB)) | ((shift & 0x1F) << INTERP_SHIM_CTRL_SHIFT_LSB);
+}
+
+static inline void interp_config_set_mask(interp_config* c, uint mask_lsb, uint mask_msb) {
+    c->ctrl = (c->ctrl & ~((0x1Fu << INTERP_SHIM_CTRL_MASK_LSB_LSB) | (0x1Fu << INTERP_SHIM_CTRL_MASK_MSB_LSB))) |
+              ((mask_lsb & 0x1F) << INTERP_SHIM_CTRL_MASK_LSB_LSB) |
+              ((mask_msb & 0x1F) << INTERP_SHIM_CTRL_MASK_MSB_LSB);
+}
+
+static inline void interp_config_set_signed(interp_config* c, bool _signed) {
+    c->ctrl = _signed ? c->ctrl | INTERP_SHIM_CTRL_SIGNED_BITS : c->ctrl & ~INTERP_SHIM_CTRL_SIGNED_BITS;
+}
+
+static inline void interp_config_set_cross_input(interp_config* c, bool cross_input) {
+    c->ctrl = cross_input ? c->ctrl | INTERP_SHIM_CTRL_CROSS_INPUT_BITS : c->ctrl & ~INTERP_SHIM_CTRL_CROSS_INPUT_BITS;
+}
+
+static inline void interp_set_config(interp_hw_t* interp, uint lane, interp_config* config) {
+    interp->ctrl[lane] = config->ctrl;
+}
+
+static inline void interp_set_base(interp_hw_t* interp, uint lane, uint32_t val) {
+    interp->base[lane] = val;
+}
+
+static inline void interp_set_accumulator(interp_hw_t* interp, uint lane, uint32_t val) {
+    interp->accum[lane] = val;
+}
+
+static inline uint32_t interp_shim_lane(const interp_hw_t* interp, uint lane) {
+    // Shifted and masked lane value, without the base
+    uint32_t ctrl = interp->ctrl[lane];
+    uint32_t input = interp->accum[(ctrl & INTERP_SHIM_CTRL_CROSS_INPUT_BITS) ? 1-lane : lane];
+    uint32_t shift = (ctrl >> INTERP_SHIM_CTRL_SHIFT_LSB) & 0x1F;
+    uint32_t lsb = (ctrl >> INTERP_SHIM_CTRL_MASK_LSB_LSB) & 0x1F;
+    uint32_t msb = (ctrl >> INTERP_SHIM_CTRL_MASK_MSB_LSB) & 0x1F;
+
+    uint32_t upto = msb == 31 ? 0xFFFFFFFF : (1u << (msb+1)) - 1;
+    uint32_t value = (input >> shift) & upto & ~((1u << lsb) - 1);
+    if ((ctrl & INTERP_SHIM_CTRL_SIGNED_BITS) && (value & (1u << msb))) {
+        value |= ~upto;
+    }
+    return value;
+}
+
+static inline uint32_t interp_peek_lane_result(interp_hw_t* interp, uint lane) {
+    return interp->base[lane] + interp_shim_lane(interp, lane);
+}
+
+static inline uint32_t interp_peek_full_result(interp_hw_t* interp) {
+    return interp->base[2] + interp_shim_lane(interp, 0) + interp_shim_lane(interp, 1);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+// Host shim for hardware spin locks, backed by atomics so that the
+// multicore code can be exercised with threads
+
+#include <atomic>
+
+#include "pico/stdlib.h"
+
+#define NUM_SPIN_LOCKS 32u
+
+// Same as the SDK, lower numbers are reserved
+#define PICO_SPINLOCK_ID_STRIPED_FIRST 16u
+
+typedef std::atomic<uint32_t> spin_lock_t;
+
+inline spin_lock_t* spin_lock_instance(uint lock_num) {
+    static spin_lock_t locks[NUM_SPIN_LOCKS];
+    if (lock_num >= NUM_SPIN_LOCKS) {
+        panic("Invalid spin lock %u\n", lock_num);
+    }
+    return &locks[lock_num];
+}
+
+inline int spin_lock_claim_unused(bool required) {
+    static std::atomic<uint> next(PICO_SPINLOCK_ID_STRIPED_FIRST);
+    uint lock_num = next++;
+    if (lock_num >= NUM_SPIN_LOCKS) {
+        if (required) {
+            panic("No spin locks are available\n");
+        }
+        return -1;
+    }
+    return (int)lock_num;
+}
+
+static inline uint32_t spin_lock_blocking(spin_lock_t* lock) {
+    while (lock->exchange(1, std::memory_order_acquire) != 0) {
+        tight_loop_contents();
+    }
+    return 0;  // No interrupts to save on the host
+}
+
+static inline void spin_unlock(spin_lock_t* lock, uint32_t saved_irq) {
+    lock->store(0, std::memory_order_release);
+}
@@ -0,0 +1,4 @@
+#pragma once
+
+// Host shim for the header generated by pico_generate_pio_header() from hub75.pio
+// The PIO programs are not used in the host build
@@ -0,0 +1,6 @@
+#pragma once
+
+// Host shim, intentionally empty apart from the basic SDK types
+// Hardware access is not available in the host build
+
+#include "pico/stdlib.h"
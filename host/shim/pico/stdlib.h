@@ -0,0 +1,62 @@
+#pragma once
+
+// Host shim for the parts of the Pico SDK that the simulation sources use
+// Only meant for the host build in host/, the firmware uses the real SDK
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+typedef unsigned int uint;
+
+#define __not_in_flash(group)
+#define __not_in_flash_func(func_name) func_name
+#define __time_critical_func(func_name) func_name
+
+#define count_of(a) (sizeof(a)/sizeof((a)[0]))
+
+[[noreturn]] static inline void panic(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    fputs("*** PANIC ***\n", stderr);
+    vfprintf(stderr, fmt, args);
+    va_end(args);
+    abort();
+}
+
+// Time functions, microsecond resolution like on the Pico
+typedef uint64_t absolute_time_t;
+
+static inline absolute_time_t get_absolute_time() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec*1000000u + ts.tv_nsec/1000;
+}
+
+static inline int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to) {
+    return (int64_t)(to - from);
+}
+
+static inline absolute_time_t delayed_by_ms(absolute_time_t t, uint32_t ms) {
+    return t + (uint64_t)ms*1000u;
+}
+
+static inline bool time_reached(absolute_time_t t) {
+    return get_absolute_time() >= t;
+}
+
+static inline void tight_loop_contents() {}
+
+static inline void sleep_us(uint64_t us) {
+    struct timespec ts = {(time_t)(us/1000000u), (long)(us%1000000u)*1000};
+    nanosleep(&ts, nullptr);
+}
+
+static inline void sleep_ms(uint32_t ms) {
+    sleep_us((uint64_t)ms*1000u);
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+// Host shim, there is no board ID on the host
+
+#include "pico/stdlib.h"
+
+#define PICO_UNIQUE_BOARD_ID_SIZE_BYTES 8
@@ -15,33 +15,39 @@
  *
  * Per row loop:
  * Per bit loop:
- *  Setup and trigger DMA to send pixel data for row to hub75_data PIO SM
+ *  Setup and trigger DMA to send the bitplane of the row to hub75_data PIO SM
  *
  *  Check if simulation step is done by checking SIO FIFO for a magic number
  *  If so, set flag display_redraw
  *
- *  Wait until DMA / PIO shifting is done
- *  Push out alignment pixels
+ *  Wait until DMA is done
  *
- *  Pulse LAT and OE using hub75_row PIO SM
+ *  Pulse LAT and OE using hub75_row PIO SM, which waits until the row is shifted in
  *
  *  Until hub75_row PIO SM is done, call display update routine
+ *  Afterwards, until hub75_row PIO SM is done, help core0 with display_worksplit
  *
  * Next bit, until full depth is done
  * Next row, until frame is done
  *
  * If frame is done and display_flip is set:
- *      Swap addresses of front and back buffers
+ *      Swap addresses of front and back bitplanes
  *      Write magic number to SIO FIFO to signal next simulation step
  *
  * Next frame, forever
  *
  * Display update routine:
  *      Restartable, e.g. state is saved between runs
- *      Clear backbuf by copying over background image
- *      Draw particles
+ *      Only if the background changed, clear pixel buffer by copying over background image
+ *      Draw particles whose pixel changed
+ *      Restore background of cells that held a particle in the last redraw, but not anymore
+ *      Convert the changed words of the pixel buffer into back bitplanes
  *      Set display_flip flag
  *
+ * The pixel buffer is kept between redraws, so the work of a redraw is proportional
+ * to the motion of the particles. Every changed pixel marks its bitplane word out of
+ * date in both bitplane buffers, each buffer catches up when it is the back buffer.
+ *
  * Framebuffers are interleaved to maximize performance
  * Given this Display:
  *   x->
@@ -55,7 +61,22 @@
  *  4C5D6E7F
  *
  * The DMA would first push out the 182... row and then the 4C5... row
- * Even numbered Framebuffer indices are rows 0-15 and odd numbered indices are rows 16-31
+ * Even numbered Framebuffer indices are the upper half of the rows and odd numbered
+ * indices the lower half. Rows of the scan are DISPLAY_PIXEL_STRIDE words apart, which
+ * is rounded up to a power of two for hub75_draw_pixel()
+ *
+ * All of this is derived from the panel description in hub75_geometry.h. Chained
+ * panels are treated as one wide panel, since the data just shifts through all of them
+ *
+ * Bitplanes:
+ *
+ * The data SM does not pick bits out of pixels, it only shifts out prepacked words.
+ * For every row of the scan and bit level, the 6 bits R0 G0 B0 R1 G1 B1 of each
+ * pixel-pair are packed DISPLAY_PAIRS_PER_WORD to a word, LSBs first. A bit level of a
+ * row is DISPLAY_PLANE_WORDS words of DMA instead of DISPLAY_WIDTH*2, and the PIO
+ * program no longer has to be patched for every bit level.
+ * Since shifting is much faster now, the two SMs hand over with PIO IRQs, so that
+ * the next bit level never overruns the latch of the current one.
  *
  * y-Coordinates are rows, x are columns
  *
@@ -74,18 +95,47 @@ static inline uint32_t gamma_correct_565_888(uint16_t pix) {
     return (b_gamma >> 2 << 16) | (g_gamma >> 14 << 8) | (r_gamma >> 24 << 0);
 }
 
-// Double-buffering
-uint32_t display_buffers[2][DISPLAY_FRAMEBUFFER_SIZE];
+// Pixels of the next frame, only read when converting them to bitplanes
+uint32_t display_pixels[DISPLAY_FRAMEBUFFER_SIZE];
 
-uint32_t* display_front_buf = &display_buffers[0][0];
-uint32_t* display_back_buf = &display_buffers[1][0];
+// Double-buffering of the bitplanes that are shifted out
+display_planes_t display_planes[2];
+
+display_planes_t* display_front_planes = &display_planes[0];
+display_planes_t* display_back_planes = &display_planes[1];
 
 const uint32_t* display_background = nullptr;
+bool display_fullredraw = true;
+
+// Background the pixel buffer was last cleared with
+const uint32_t* display_lastbackground = nullptr;
+
+// Cells with particles as y << 8 | x, of the last and the current redraw
+uint16_t display_occupied[2][DISPLAY_WIDTH*DISPLAY_HEIGHT];
+static_assert(DISPLAY_WIDTH <= 256 && DISPLAY_HEIGHT <= 256, "Cells of particles are 8-bit coordinates");
+uint32_t display_occupiedcount[2];
+uint8_t display_occupiedcur = 0;
 
-uint32_t display_wait = DISPLAY_WAIT_US;
+// Redraw that last drew a particle into each cell
+// Only checked for cells of the last redraw, so wrapping around is fine
+uint8_t display_cellstamp[DISPLAY_WIDTH*DISPLAY_HEIGHT];
+uint8_t display_stamp = 0;
+
+// Bitplane words that are out of date, by row of the scan and word, for both buffers
+uint32_t display_dirty[2][DISPLAY_DIRTY_WORDS];
+
+uint8_t display_brightness;
+
+// OE pulse width of the lowest bit level, see hub75_set_brightness()
+uint32_t display_pulse_lsb;
+
+worksplit_t display_worksplit;
+
+volatile uint32_t display_refreshes = 0;
 
 uint32_t display_particlecount;
-particle_t display_particles[SIM_MAX_PARTICLECOUNT];
+const particle_cell_t* display_particles = nullptr;
+const uint32_t* display_palette = nullptr;
 
 PIO display_pio = pio0;
 uint display_sm_data, display_sm_row;
@@ -93,6 +143,23 @@ uint display_offset_data, display_offset_row;
 
 int display_dma_chan;
 
+#if DISPLAY_DMA_CHAIN
+// Copies the blocks into display_dma_chan, see hub75_chain.cpp
+int display_dma_ctrl_chan;
+
+// Blocks showing each of the bitplane buffers, and the ones the chain restarts with
+hub75_chain_block_t display_chain[2][DISPLAY_CHAIN_STRIDE];
+hub75_chain_block_t* volatile display_chain_next = display_chain[0];
+
+uint32_t display_rowwords[DISPLAY_SCAN][DISPLAY_BITDEPTH];
+
+// Row words of the next frame, copied over display_rowwords by the chain
+uint32_t display_rowwords_staged[DISPLAY_SCAN][DISPLAY_BITDEPTH];
+
+// OE pulse width of the lowest bit level the staged row words were made for
+uint32_t display_staged_lsb;
+#endif
+
 bool display_redraw = false;
 bool display_flip = false;
 
@@ -116,6 +183,9 @@ void hub75_init() {
             DISPLAY_ROWSEL_BASE+2, "HUB75 C Pin",
             DISPLAY_ROWSEL_BASE+3, "HUB75 D Pin"
             ));
+#if DISPLAY_ROWSEL_COUNT > 4
+    bi_decl(bi_1pin_with_name(DISPLAY_ROWSEL_BASE+4, "HUB75 E Pin"));
+#endif
     bi_decl(bi_3pins_with_names(
             DISPLAY_CLKPIN, "HUB75 CLK Pin",
             DISPLAY_STROBEPIN, "HUB75 LAT / STB Pin",
@@ -134,7 +204,9 @@ void hub75_init() {
             display_sm_data,
             display_offset_data,
             DISPLAY_DATAPINS_BASE,
-            DISPLAY_CLKPIN
+            DISPLAY_CLKPIN,
+            DISPLAY_WIDTH,
+            DISPLAY_DATA_CLKDIV
             );
     hub75_row_program_init(
             display_pio,
@@ -157,30 +229,193 @@ void hub75_init() {
             &c,
             &pio0_hw->txf[display_sm_data],
             NULL,  // Will be set later for each transfer
-            DISPLAY_SIZE*2,  // Because we shift out two rows at once
+            DISPLAY_PLANE_WORDS,  // One bit level of two rows at once
+            false
+            );
+
+#if DISPLAY_DMA_CHAIN
+    hub75_chain_init();
+#endif
+
+    hub75_set_brightness(DISPLAY_BRIGHTNESS);
+}
+
+static inline uint32_t hub75_row_word(int row, int bit, uint32_t lsb) {
+    // Row select and OE pulse width for the row SM, which asserts OE for one cycle more
+    // than it is given. Every bit level is lit exactly twice as long as the one below
+    return row | (((lsb << bit) - 1) << DISPLAY_ROWSEL_BITS);
+}
+
+void hub75_set_brightness(uint8_t brightness) {
+    // Scales the OE pulses of all bit levels alike, so dimming keeps the color depth and
+    // costs neither refresh rate nor time on core1. The shortest pulse is one cycle,
+    // so very low values all end up equally dim
+    display_brightness = brightness;
+    uint32_t lsb = (DISPLAY_PULSE_CYCLES*brightness + 127)/255;
+    // With DISPLAY_DMA_CHAIN, core1 stages new row words with the next flip
+    display_pulse_lsb = lsb > 0 ? lsb : 1;
+}
+
+#if DISPLAY_DMA_CHAIN
+static void hub75_chain_stage() {
+    // Only called right after a restart, so the copy at the end of the frame never
+    // sees the staged words half written
+    uint32_t lsb = display_pulse_lsb;
+    for (int row = 0; row < DISPLAY_SCAN; ++row) {
+        for (int bit = 8-DISPLAY_BITDEPTH; bit < 8; ++bit) {
+            display_rowwords_staged[row][bit-(8-DISPLAY_BITDEPTH)] = hub75_row_word(row, bit, lsb);
+        }
+    }
+    display_staged_lsb = lsb;
+}
+
+void hub75_chain_init() {
+    // Row words are filled in by hub75_chain_start()
+
+    // Control channel writes four registers of the executing channel, wrapping around
+    display_dma_ctrl_chan = dma_claim_unused_channel(true);
+    dma_channel_config c = dma_channel_get_default_config(display_dma_ctrl_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_ring(&c, true, 4);
+
+    dma_channel_configure(
+            display_dma_ctrl_chan,
+            &c,
+            &dma_hw->ch[display_dma_chan].read_addr,
+            NULL,  // Set by hub75_chain_start() and by the chain itself
+            4,
             false
             );
+
+    // Block types of the executing channel
+    c = dma_channel_get_default_config(display_dma_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_chain_to(&c, display_dma_ctrl_chan);
+    channel_config_set_dreq(&c, DREQ_PIO0_TX0+display_sm_data);
+    uint32_t data_ctrl = channel_config_get_ctrl_value(&c);
+    channel_config_set_dreq(&c, DREQ_PIO0_TX0+display_sm_row);
+    uint32_t row_ctrl = channel_config_get_ctrl_value(&c);
+
+    // Copy of the staged row words
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_dreq(&c, DREQ_FORCE);
+    uint32_t copy_ctrl = channel_config_get_ctrl_value(&c);
+
+    // Chaining to itself disables chaining, the restart triggers the control channel
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_chain_to(&c, display_dma_chan);
+    channel_config_set_dreq(&c, DREQ_FORCE);
+    uint32_t restart_ctrl = channel_config_get_ctrl_value(&c);
+
+    for (int i = 0; i < 2; ++i) {
+        hub75_chain_config_t config = {
+                .planes = (uint32_t) &display_planes[i],
+                .rowwords = (uint32_t) &display_rowwords[0][0],
+                .staged = (uint32_t) &display_rowwords_staged[0][0],
+                .data_txf = (uint32_t) &display_pio->txf[display_sm_data],
+                .row_txf = (uint32_t) &display_pio->txf[display_sm_row],
+                .data_ctrl = data_ctrl,
+                .row_ctrl = row_ctrl,
+                .copy_ctrl = copy_ctrl,
+                .restart_ctrl = restart_ctrl,
+                .next = (uint32_t) &display_chain_next,
+                .restart = (uint32_t) &dma_hw->ch[display_dma_ctrl_chan].al3_read_addr_trig,
+        };
+        hub75_chain_build(display_chain[i], &config);
+    }
 }
 
+void hub75_chain_start() {
+    // Runs forever from here on, with the row words of the current brightness
+    hub75_chain_stage();
+    memcpy(display_rowwords, display_rowwords_staged, sizeof(display_rowwords));
+
+    display_chain_next = display_chain[display_front_planes == &display_planes[0] ? 0 : 1];
+    dma_channel_set_read_addr(display_dma_ctrl_chan, display_chain_next, true);
+}
+
+bool __not_in_flash_func(hub75_chain_showing)(const display_planes_t* planes) {
+    // Whether the chain is in the blocks of the given buffer, e.g. picked up a flip
+    const hub75_chain_block_t* blocks = display_chain[planes == &display_planes[0] ? 0 : 1];
+    return hub75_chain_contains((uint32_t) blocks, dma_hw->ch[display_dma_ctrl_chan].read_addr);
+}
+#endif
+
 [[noreturn]] void __not_in_flash_func(hub75_main)() {
     puts("Hello from HUB75!");
 
+    // Interpolators are per core, so this has to happen here instead of hub75_init()
+    hub75_interp_init();
+
     DISPLAY_REDRAWSTATE redrawstate = DISPLAY_REDRAWSTATE_IDLE;
 
     // Fill both framebuffers with a default pattern
-    for (int x = 0; x < DISPLAY_SIZE; ++x) {
-        for (int y = 0; y < DISPLAY_SIZE; ++y) {
-            uint32_t c = (x*8) << 16 | (y*8) << 8 | 16 << 0;
-            hub75_draw_pixel(display_front_buf, x, y, c);
-            hub75_draw_pixel(display_back_buf, x, y, c);
+    for (int x = 0; x < DISPLAY_WIDTH; ++x) {
+        for (int y = 0; y < DISPLAY_HEIGHT; ++y) {
+            uint32_t c = ((x*256/DISPLAY_WIDTH) << 16) | ((y*256/DISPLAY_HEIGHT) << 8) | 16 << 0;
+            hub75_draw_pixel(display_pixels, x, y, c);
         }
     }
+    for (int row = 0; row < DISPLAY_SCAN; ++row) {
+        hub75_convert_row(display_front_planes, display_pixels, row);
+        hub75_convert_row(display_back_planes, display_pixels, row);
+    }
 
     puts("HUB75 is done initializing framebuffers");
 
     // Simulation waits until we are ready
     multicore_fifo_push_blocking(DISPLAY_TRIGGER_SIMULATION_MAGIC_NUMBER);
 
+#if DISPLAY_DMA_CHAIN
+    // The refresh runs on its own, this core only redraws and flips
+    hub75_chain_start();
+
+    while (true) {
+        // Help core0 until new simulation data is available
+        while (!multicore_fifo_rvalid()) {
+            if (!worksplit_help(&display_worksplit)) {
+                tight_loop_contents();
+            }
+        }
+        if (multicore_fifo_pop_blocking() != DISPLAY_TRIGGER_REDRAW_MAGIC_NUMBER) {
+            continue;
+        }
+
+        // Nothing to wait for, so this redraws in one go
+        redrawstate = hub75_update(redrawstate);
+
+        // The chain picks up the new buffer at the end of the current frame
+        display_chain_next = display_chain[display_back_planes == &display_planes[0] ? 0 : 1];
+        while (!hub75_chain_showing(display_back_planes)) {
+            if (!worksplit_help(&display_worksplit)) {
+                tight_loop_contents();
+            }
+        }
+
+        // The restart was just now, the new row words are copied at the end of this frame
+        if (display_staged_lsb != display_pulse_lsb) {
+            hub75_chain_stage();
+        }
+
+        // Swap buffers
+        display_planes_t* tmp = display_back_planes;
+        display_back_planes = display_front_planes;
+        display_front_planes = tmp;
+
+        display_framenum++;
+
+        if (!multicore_fifo_wready()) {
+            // Should never happen, panic
+            panic("Tried to signal finished redraw, but FIFO was full!\n");
+        }
+        multicore_fifo_push_blocking(DISPLAY_TRIGGER_SIMULATION_MAGIC_NUMBER);
+    }
+#else
     while (true) {
         // per-Frame loop
 
@@ -190,12 +425,9 @@ void hub75_init() {
             for (int bit = 8-DISPLAY_BITDEPTH; bit < 8; ++bit) {
                 // per-Bit level loop
 
-                // Set correct bit offset in data SM
-                hub75_data_set_shift(display_pio, display_sm_data, display_offset_data, bit);
-
-                // Start DMA to push out pixels
+                // Start DMA to push out the bitplane
                 dma_channel_set_read_addr(display_dma_chan,
-                                          &display_front_buf[row*DISPLAY_SIZE*2],
+                                          &(*display_front_planes)[row][bit-(8-DISPLAY_BITDEPTH)][0],
                                           true);
 
                 // Check SIO FIFO if new simulation data is available
@@ -207,15 +439,10 @@ void hub75_init() {
                     display_redraw = true;
                 }
 
-                // Wait for DMA completion to prevent dummy pixels being inserted at the wrong position
+                // Wait for DMA completion, the row SM waits for the shifting itself
                 // We could try and redraw here as well, but the dma (and shifting) itself is quite fast
                 dma_channel_wait_for_finish_blocking(display_dma_chan);
 
-                // Push two dummy pixels to properly synchronize
-                // Also acts as a synchronization between row and data
-                pio_sm_put_blocking(display_pio, display_sm_data, 0);
-                pio_sm_put_blocking(display_pio, display_sm_data, 0);
-
                 // Just in case the flags were still set
                 hub75_pio_sm_clearstall();
 
@@ -231,17 +458,20 @@ void hub75_init() {
                     }
                 }
 
+                // Spend the rest of the wait on simulation work, if core0 has any
+                // Redrawing comes first, since the frame can't be flipped without it
+                if (bit > 4) {
+                    while (hub75_pio_sm_stalled() && worksplit_help(&display_worksplit)) {
+                        tight_loop_contents();
+                    }
+                }
+
                 // Finish waiting if redraw was quick or not necessary
                 // Also clears FIFO stall flags
-                hub75_wait_tx_stall(display_pio, display_sm_data);
                 hub75_wait_tx_stall(display_pio, display_sm_row);
 
                 // Pulse LAT and OE using PIO
-                // TODO: check scaling of delay
-                pio_sm_put_blocking(display_pio,
-                                    display_sm_row,
-                                    row | ((100u * (1u << bit)) << DISPLAY_ROWSEL_COUNT)
-                );
+                pio_sm_put_blocking(display_pio, display_sm_row, hub75_row_word(row, bit, display_pulse_lsb));
             }
         }
 
@@ -249,15 +479,17 @@ void hub75_init() {
         //    printf("REDRAW Carry\n");
         //}
 
+        display_refreshes++;
+
         // Ready to flip
         if (display_flip) {
             //printf("Flip\n");
             display_flip = false;
 
             // Swap buffers
-            uint32_t* tmp = display_back_buf;
-            display_back_buf = display_front_buf;
-            display_front_buf = tmp;
+            display_planes_t* tmp = display_back_planes;
+            display_back_planes = display_front_planes;
+            display_front_planes = tmp;
 
             display_framenum++;
 
@@ -270,18 +502,61 @@ void hub75_init() {
             }
             multicore_fifo_push_blocking(DISPLAY_TRIGGER_SIMULATION_MAGIC_NUMBER);
         }
+    }
+#endif
+}
 
-        if (display_wait > 0) {
-            sleep_us(display_wait);
-        }
+static inline void __not_in_flash_func(hub75_mark_dirty)(uint32_t x, uint32_t y) {
+    // Both bitplane buffers have to pick up the change
+    uint32_t idx = (y % DISPLAY_SCAN)*DISPLAY_PLANE_WORDS + x/DISPLAY_PAIRS_PER_WORD;
+    display_dirty[0][idx/32] |= 1u << (idx%32);
+    display_dirty[1][idx/32] |= 1u << (idx%32);
+}
+
+static void hub75_mark_all_dirty() {
+    memset(display_dirty, 0xFF, sizeof(display_dirty));
+    if ((DISPLAY_SCAN*DISPLAY_PLANE_WORDS) % 32 != 0) {
+        // Bits past the last word must stay clear
+        uint32_t mask = (1u << ((DISPLAY_SCAN*DISPLAY_PLANE_WORDS) % 32)) - 1;
+        display_dirty[0][DISPLAY_DIRTY_WORDS-1] = mask;
+        display_dirty[1][DISPLAY_DIRTY_WORDS-1] = mask;
+    }
+}
 
+static inline void __not_in_flash_func(hub75_update_pixel)(uint32_t x, uint32_t y, uint32_t color) {
+    uint32_t* pixel = &display_pixels[hub75_pixel_index(x, y)];
+    if (*pixel != color) {
+        *pixel = color;
+        hub75_mark_dirty(x, y);
     }
 }
 
+static inline void __not_in_flash_func(hub75_draw_particle)(const particle_cell_t* p) {
+    // Remember the cell, so that the next redraw can tell whether it was vacated
+    uint32_t cell = p->y*DISPLAY_WIDTH + p->x;
+    display_cellstamp[cell] = display_stamp;
+    display_occupied[display_occupiedcur][display_occupiedcount[display_occupiedcur]++] = p->y << 8 | p->x;
+
+    hub75_update_pixel(p->x, p->y, display_palette[p->color]);
+}
+
 DISPLAY_REDRAWSTATE __not_in_flash_func(hub75_update)(DISPLAY_REDRAWSTATE state) {
     if (state == DISPLAY_REDRAWSTATE_IDLE) {
-        // Fresh start, start by clearing
-        state = DISPLAY_REDRAWSTATE_CLEAR;
+        // Fresh start
+        display_stamp++;
+        display_occupiedcur ^= 1;
+        display_occupiedcount[display_occupiedcur] = 0;
+
+        if (display_fullredraw || display_background != display_lastbackground) {
+            // New background, start by clearing
+            display_fullredraw = false;
+            display_lastbackground = display_background;
+            hub75_mark_all_dirty();
+            state = DISPLAY_REDRAWSTATE_CLEAR;
+        } else {
+            // Pixels without particles still show the background
+            state = DISPLAY_REDRAWSTATE_PARTICLES;
+        }
         display_redraw_curidx = 0;
     }
 
@@ -300,24 +575,19 @@ DISPLAY_REDRAWSTATE __not_in_flash_func(hub75_update)(DISPLAY_REDRAWSTATE state)
             // Note that while we could use hub75_draw_pixel() here, it would be
             // far less efficient. Since we always copy a row at a time, we can
             // pre-calculate the starting address and thus save us a branch on every pixel
-            int startaddr = display_redraw_curidx*DISPLAY_SIZE*2;
+            int startaddr = display_redraw_curidx*DISPLAY_PIXEL_STRIDE;
             if (display_redraw_curidx >= DISPLAY_SCAN) {
                 // Interleave-shifted row
-                startaddr = (display_redraw_curidx-DISPLAY_SCAN)*DISPLAY_SIZE*2+1;
+                startaddr = (display_redraw_curidx-DISPLAY_SCAN)*DISPLAY_PIXEL_STRIDE+1;
             }
 
-            for (int x = 0; x < DISPLAY_SIZE; x++) {
-                display_back_buf[startaddr+2*x] = display_background[display_redraw_curidx*DISPLAY_SIZE+x];
+            for (int x = 0; x < DISPLAY_WIDTH; x++) {
+                display_pixels[startaddr+2*x] = display_background[display_redraw_curidx*DISPLAY_WIDTH+x];
             }
 
             display_redraw_curidx++;
-            if (display_redraw_curidx >= DISPLAY_SIZE) {
-                if (display_particlecount > 0) {
-                    // Only proceed to draw particles if there are any
-                    state = DISPLAY_REDRAWSTATE_PARTICLES;
-                } else {
-                    state = DISPLAY_REDRAWSTATE_IDLE;
-                }
+            if (display_redraw_curidx >= DISPLAY_HEIGHT) {
+                state = DISPLAY_REDRAWSTATE_PARTICLES;
                 display_redraw_curidx = 0;
             }
         } else if (state == DISPLAY_REDRAWSTATE_PARTICLES) {
@@ -327,24 +597,54 @@ DISPLAY_REDRAWSTATE __not_in_flash_func(hub75_update)(DISPLAY_REDRAWSTATE state)
                 // If there are more than eight particles remaining, draw them at once
                 // Reduces overhead from loop, since the drawing itself is quite fast
                 for (int i = 0; i < 8; ++i) {
-                    hub75_draw_pixel(display_back_buf,
-                                     display_particles[display_redraw_curidx].x / 256,
-                                     display_particles[display_redraw_curidx].y / 256,
-                                     display_particles[display_redraw_curidx].color
-                    );
+                    hub75_draw_particle(&display_particles[display_redraw_curidx]);
                     display_redraw_curidx++;
                 }
-            } else {
+            } else if (display_redraw_curidx < display_particlecount) {
                 // Not enough particles remaining, draw them one by one
-                hub75_draw_pixel(display_back_buf,
-                                 display_particles[display_redraw_curidx].x / 256,
-                                 display_particles[display_redraw_curidx].y / 256,
-                                 display_particles[display_redraw_curidx].color
-                );
+                hub75_draw_particle(&display_particles[display_redraw_curidx]);
                 display_redraw_curidx++;
             }
 
             if (display_redraw_curidx >= display_particlecount) {
+                state = DISPLAY_REDRAWSTATE_VACATE;
+                display_redraw_curidx = 0;
+            }
+        } else if (state == DISPLAY_REDRAWSTATE_VACATE) {
+            // Restore the background of up to eight cells of the last redraw per iteration
+            const uint16_t* last = display_occupied[display_occupiedcur ^ 1];
+            uint32_t lastcount = display_occupiedcount[display_occupiedcur ^ 1];
+
+            for (int i = 0; i < 8 && display_redraw_curidx < lastcount; ++i) {
+                uint32_t x = last[display_redraw_curidx] & 0xFF;
+                uint32_t y = last[display_redraw_curidx] >> 8;
+                uint32_t cell = y*DISPLAY_WIDTH + x;
+                if (display_cellstamp[cell] != display_stamp) {
+                    // No particle in this cell anymore
+                    hub75_update_pixel(x, y, display_background != nullptr ? display_background[cell] : 0);
+                }
+                display_redraw_curidx++;
+            }
+
+            if (display_redraw_curidx >= lastcount) {
+                state = DISPLAY_REDRAWSTATE_PLANES;
+                display_redraw_curidx = 0;
+            }
+        } else if (state == DISPLAY_REDRAWSTATE_PLANES) {
+            // Convert one out of date word of every bit level per iteration, a whole row takes too long
+            // Skips 32 words per iteration that are up to date
+            uint32_t* dirty = &display_dirty[display_back_planes == &display_planes[0] ? 0 : 1][display_redraw_curidx];
+            if (*dirty != 0) {
+                uint32_t idx = display_redraw_curidx*32 + __builtin_ctz(*dirty);
+                *dirty &= *dirty - 1;
+                hub75_convert_word(display_back_planes, display_pixels,
+                                   idx / DISPLAY_PLANE_WORDS,
+                                   idx % DISPLAY_PLANE_WORDS);
+            } else {
+                display_redraw_curidx++;
+            }
+
+            if (display_redraw_curidx >= DISPLAY_DIRTY_WORDS) {
                 // We're done, loop will break due to state
                 state = DISPLAY_REDRAWSTATE_IDLE;
                 display_redraw_curidx = 0;
@@ -359,12 +659,17 @@ DISPLAY_REDRAWSTATE __not_in_flash_func(hub75_update)(DISPLAY_REDRAWSTATE state)
 }
 
 bool hub75_pio_sm_stalled() {
+#if DISPLAY_DMA_CHAIN
+    // The chain keeps the SMs busy, there is never a wait to fill
+    return true;
+#else
     // Checks whether the state machines are stalled
     // We currently only check the row SM, since it will take longer for higher
     // bit levels
     uint32_t txstall_mask = 1u << (PIO_FDEBUG_TXSTALL_LSB + display_sm_row);
     //txstall_mask |= 1u << (PIO_FDEBUG_TXSTALL_LSB + display_sm_data);
     return !(display_pio->fdebug & txstall_mask);
+#endif
 }
 
 void hub75_pio_sm_clearstall() {
@@ -373,12 +678,45 @@ void hub75_pio_sm_clearstall() {
     display_pio->fdebug = txstall_mask;
 }
 
-static inline void __not_in_flash_func(hub75_draw_pixel)(uint32_t* buf, uint32_t x, uint32_t y, uint32_t color) {
-    if (y<DISPLAY_SCAN) {
-        // Normal, store pixel
-        buf[y*DISPLAY_SIZE*2+2*x] = color;
-    } else {
-        // Above display scan, store as interleaved
-        buf[(y-DISPLAY_SCAN)*DISPLAY_SIZE*2+2*x+1] = color;
+void __not_in_flash_func(hub75_convert_word)(display_planes_t* planes, const uint32_t* buf, int row, int w) {
+    // Pack the pixel-pairs of word w of a row of the scan into the bitplanes of all bit levels
+    // Pixels are 0x00BBGGRR, so the bits of a level are at b, b+8 and b+16
+    const uint32_t* pairs = &buf[row*DISPLAY_PIXEL_STRIDE + w*DISPLAY_PAIRS_PER_WORD*2];
+    for (int bit = 8-DISPLAY_BITDEPTH; bit < 8; ++bit) {
+        uint32_t word = 0;
+        for (int p = 0; p < DISPLAY_PAIRS_PER_WORD; ++p) {
+            uint32_t top = pairs[2*p] >> bit;
+            uint32_t bottom = pairs[2*p+1] >> bit;
+            uint32_t rgb = (top & 1) | ((top >> 7) & 2) | ((top >> 14) & 4);
+            rgb |= ((bottom & 1) | ((bottom >> 7) & 2) | ((bottom >> 14) & 4)) << 3;
+            word |= rgb << (6*p);
+        }
+        (*planes)[row][bit-(8-DISPLAY_BITDEPTH)][w] = word;
+    }
+}
+
+void hub75_convert_row(display_planes_t* planes, const uint32_t* buf, int row) {
+    for (int w = 0; w < DISPLAY_PLANE_WORDS; ++w) {
+        hub75_convert_word(planes, buf, row, w);
     }
+}
+
+void hub75_interp_init() {
+    // Rows above the display scan are stored interleaved with the ones below:
+    // index = (y%DISPLAY_SCAN)*DISPLAY_PIXEL_STRIDE + 2*x + y/DISPLAY_SCAN
+    // The accumulator of lane 0 is y*DISPLAY_PIXEL_STRIDE, lane 0 keeps the bits of the row
+    // within the scan and lane 1 picks the half from the same input. 2*x goes in the base
+    constexpr uint32_t rowbits = __builtin_ctz(DISPLAY_PIXEL_STRIDE);
+    constexpr uint32_t scanbits = __builtin_ctz(DISPLAY_SCAN);
+
+    interp_config c = interp_default_config();
+    interp_config_set_shift(&c, 0);
+    interp_config_set_mask(&c, rowbits, rowbits+scanbits-1);
+    interp_set_config(interp1, 0, &c);
+
+    c = interp_default_config();
+    interp_config_set_cross_input(&c, true);
+    interp_config_set_shift(&c, rowbits+scanbits);
+    interp_config_set_mask(&c, 0, 0);
+    interp_set_config(interp1, 1, &c);
 }
\ No newline at end of file
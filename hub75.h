@@ -1,35 +1,34 @@
 #pragma once
 
 #include <stdio.h>
+#include <string.h>
 #include "math.h"
 #include "pico/stdlib.h"
 #include "pico/binary_info.h"
 #include "pico/multicore.h"
 #include "hardware/dma.h"
 #include "hardware/pio.h"
+#include "hardware/interp.h"
 
 #include "hub75.pio.h"
+#include "hub75_geometry.h"
+#include "hub75_chain.h"
 
 #include "simulation.h"
-
-// Size of the display, currently only square displays are supported
-#define DISPLAY_SIZE 32
-
-// Scan factor of the display
-// Code will currently not work correctly if this is not exactly half of DISPLAY_SIZE
-#define DISPLAY_SCAN 16
-
-// Integer between 1 and 8
-// Lower numbers cause LSBs to be skipped
-#define DISPLAY_BITDEPTH 8
+#include "worksplit.h"
 
 // R0, G0, B0, R1, G1, B1 pins, consecutive
 #define DISPLAY_DATAPINS_BASE 6
 #define DISPLAY_DATAPINS_COUNT 6
 
 // A, B, C, D pins for row selection, consecutive
+// E follows D for 1/32 scan, which needs CLK, LAT and OE to move up by one pin
+// DISPLAY_ROWSEL_COUNT is derived from the scan, see hub75_geometry.h
 #define DISPLAY_ROWSEL_BASE 12
-#define DISPLAY_ROWSEL_COUNT 4
+
+// Bits of the row select in the words for the hub75_row PIO SM, must match its program
+// Unused pins are simply not written by the SM
+#define DISPLAY_ROWSEL_BITS 5
 
 // CLK pin
 #define DISPLAY_CLKPIN 16
@@ -37,14 +36,25 @@
 #define DISPLAY_STROBEPIN 17
 #define DISPLAY_OENPIN DISPLAY_STROBEPIN+1
 
-// Amount of pixels per framebuffer
-#define DISPLAY_FRAMEBUFFER_SIZE (DISPLAY_SIZE*DISPLAY_SIZE)
+static_assert(DISPLAY_ROWSEL_BASE+DISPLAY_ROWSEL_COUNT <= DISPLAY_CLKPIN
+              || DISPLAY_ROWSEL_BASE > DISPLAY_OENPIN, "Row select pins overlap CLK, LAT or OE");
 
-// Amount of time to blank the display after each full frame draw
-// 0 for full brightness, increase to dim
-// ~3000 for half-brightness
-// Note that very high values will cause FPS drops and may cause visible flicker
-#define DISPLAY_WAIT_US 3000
+// Clock divider of hub75_data, which shifts a pixel-pair every 6 PIO cycles
+// 3 clocks the panel at a bit below the sys/16 of the old program. 1 would give
+// sys/6, which has not been tried on a panel yet
+#define DISPLAY_DATA_CLKDIV 3
+
+// OE pulse width of the lowest bit level at full brightness, in system clock cycles
+// Each bit level above is lit twice as long
+#define DISPLAY_PULSE_CYCLES 100
+
+// Brightness set by hub75_init(), 255 for full brightness
+// ~128 for half-brightness, can be changed at runtime with hub75_set_brightness()
+#define DISPLAY_BRIGHTNESS 128
+
+// Refresh the display with a self-running DMA chain instead of the loop in hub75_main()
+// Frees core1 for redrawing and simulation work
+#define DISPLAY_DMA_CHAIN 0
 
 // An arbitrary 32-bit number to use for triggering redraws / simulations
 // We could just use the same number or even 0, but this can catch bugs if
@@ -52,27 +62,67 @@
 #define DISPLAY_TRIGGER_REDRAW_MAGIC_NUMBER 0xABCDEF01
 #define DISPLAY_TRIGGER_SIMULATION_MAGIC_NUMBER 0x00ABCDEF
 
+// Words of the masks of bitplane words that are out of date, see hub75_mark_dirty()
+#define DISPLAY_DIRTY_WORDS ((DISPLAY_SCAN*DISPLAY_PLANE_WORDS + 31)/32)
+
 enum DISPLAY_REDRAWSTATE {
     DISPLAY_REDRAWSTATE_IDLE,
     DISPLAY_REDRAWSTATE_CLEAR,
     DISPLAY_REDRAWSTATE_PARTICLES,
+    DISPLAY_REDRAWSTATE_VACATE,
+    DISPLAY_REDRAWSTATE_PLANES,
 };
 
+
 extern const uint32_t* display_background;
 
+// Set when the background changed without display_background changing, e.g. for
+// animations drawing into anim_framebuf. Forces the next redraw to copy all of it
+extern bool display_fullredraw;
+
+// Particles to draw, owned by the display until it acknowledges the redraw
 extern uint32_t display_particlecount;
-extern particle_t display_particles[SIM_MAX_PARTICLECOUNT];
+extern const particle_cell_t* display_particles;
+extern const uint32_t* display_palette;
+
+// Brightness of the display, only to be changed with hub75_set_brightness()
+extern uint8_t display_brightness;
+
+// Work from core0 that the display driver helps with while waiting for the PIO
+extern worksplit_t display_worksplit;
 
-extern uint32_t display_wait;
+// Frames refreshed by the loop in hub75_main(), for measuring the refresh rate
+// Not counted with DISPLAY_DMA_CHAIN, since no code runs per frame then
+extern volatile uint32_t display_refreshes;
 
 // TODO: write docs for hub75_* functions
 void hub75_init();
+void hub75_interp_init();
 
 [[noreturn]] void hub75_main();
 
+void hub75_set_brightness(uint8_t brightness);
+
 bool hub75_pio_sm_stalled();
 void hub75_pio_sm_clearstall();
 
 DISPLAY_REDRAWSTATE hub75_update(DISPLAY_REDRAWSTATE state);
 
-static inline void hub75_draw_pixel(uint32_t* buf, uint32_t x, uint32_t y, uint32_t color);
\ No newline at end of file
+void hub75_chain_init();
+void hub75_chain_start();
+bool hub75_chain_showing(const display_planes_t* planes);
+
+void hub75_convert_word(display_planes_t* planes, const uint32_t* buf, int row, int w);
+void hub75_convert_row(display_planes_t* planes, const uint32_t* buf, int row);
+
+// Only on core1, since interpolators are per core
+static inline uint32_t __not_in_flash_func(hub75_pixel_index)(uint32_t x, uint32_t y) {
+    // Interleaved index from interpolator 1, see hub75_interp_init()
+    interp_set_accumulator(interp1, 0, y*DISPLAY_PIXEL_STRIDE);
+    interp_set_base(interp1, 2, 2*x);
+    return interp_peek_full_result(interp1);
+}
+
+static inline void __not_in_flash_func(hub75_draw_pixel)(uint32_t* buf, uint32_t x, uint32_t y, uint32_t color) {
+    buf[hub75_pixel_index(x, y)] = color;
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+#include "hub75_chain.h"
+
+/*
+ * Self-running DMA refresh
+ *
+ * Two DMA channels take over the per row and per bit loop of hub75_main():
+ *
+ * The control channel copies one block of four words into the registers of the
+ * executing channel, which starts it. Once the executing channel is done, it chains
+ * back to the control channel, which copies the next block.
+ *
+ * For every row of the scan and bit level, one block pushes the bitplane to the data SM
+ * and one pushes the row word to the row SM. The FIFOs only take a few words, so the
+ * blocks are paced by the SMs, which in turn hand over with PIO IRQs.
+ *
+ * At the end of the frame, one block copies the staged row words over the ones the
+ * row blocks read. Changing the OE pulse widths thus never tears a frame, as long as
+ * the staged words are not written while the copy runs, see hub75_main().
+ *
+ * The last block copies the pointer at `next` into the read address trigger of
+ * the control channel, which restarts it at the blocks of the next frame. Flipping
+ * buffers is just changing that pointer, the chain picks it up at the end of the frame.
+ */
+
+void hub75_chain_build(hub75_chain_block_t* blocks, const hub75_chain_config_t* config) {
+    hub75_chain_block_t* b = blocks;
+    for (int row = 0; row < DISPLAY_SCAN; ++row) {
+        for (int bit = 0; bit < DISPLAY_BITDEPTH; ++bit) {
+            uint32_t plane = ((row*DISPLAY_BITDEPTH) + bit)*DISPLAY_PLANE_WORDS;
+            *b++ = {config->planes + 4*plane, config->data_txf, DISPLAY_PLANE_WORDS, config->data_ctrl};
+            *b++ = {config->rowwords + 4*(row*DISPLAY_BITDEPTH + bit), config->row_txf, 1, config->row_ctrl};
+        }
+    }
+    *b++ = {config->staged, config->rowwords, DISPLAY_SCAN*DISPLAY_BITDEPTH, config->copy_ctrl};
+    *b = {config->next, config->restart, 1, config->restart_ctrl};
+}
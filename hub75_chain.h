@@ -0,0 +1,48 @@
+#pragma once
+
+// DMA control blocks for refreshing the display without the CPU, see hub75_chain_build()
+// Kept free of SDK headers, so that the chain can be checked by a host model
+
+#include <stdint.h>
+
+#include "hub75_geometry.h"
+
+// Blocks per frame: bitplane and row word for every row and bit level, then the copy
+// of the staged row words and the restart
+#define DISPLAY_CHAIN_BLOCKS (DISPLAY_SCAN*DISPLAY_BITDEPTH*2 + 2)
+
+// Space for the blocks of one frame, including one unused block, see hub75_chain_contains()
+#define DISPLAY_CHAIN_STRIDE (DISPLAY_CHAIN_BLOCKS + 1)
+
+// One block is written to the first four registers of the executing DMA channel,
+// the last write triggers it
+typedef struct hub75_chain_block {
+    uint32_t read_addr;
+    uint32_t write_addr;
+    uint32_t transfer_count;
+    uint32_t ctrl;
+} hub75_chain_block_t;
+
+// Addresses and CTRL register values the chain is built from
+// Plain 32-bit addresses, so that the host model can use its own address space
+typedef struct hub75_chain_config {
+    uint32_t planes;    // Bitplanes shown by this chain, a display_planes_t
+    uint32_t rowwords;  // Words for the row SM, one per row and bit level
+    uint32_t staged;    // Row words for the next frame, copied over rowwords before the restart
+    uint32_t data_txf, row_txf;  // TX FIFOs of the data and row SMs
+    uint32_t data_ctrl, row_ctrl;  // Paced by the SM, chain back to the control channel
+    uint32_t copy_ctrl;  // Unpaced, chains back to the control channel
+    uint32_t restart_ctrl;  // Unpaced, without chaining
+    uint32_t next;      // Pointer to the blocks of the next frame
+    uint32_t restart;   // Read address trigger of the control channel
+} hub75_chain_config_t;
+
+void hub75_chain_build(hub75_chain_block_t* blocks, const hub75_chain_config_t* config);
+
+static inline bool hub75_chain_contains(uint32_t blocks, uint32_t addr) {
+    // Whether the control channel reading from addr is in the frame of the blocks at blocks
+    // Once it has read the restart block, it points right behind it until the restart is done.
+    // That is the unused block, and not the start of the other chain, so a chain is only
+    // reported after the restart actually loaded it
+    return addr >= blocks && addr <= blocks + sizeof(hub75_chain_block_t)*DISPLAY_CHAIN_BLOCKS;
+}
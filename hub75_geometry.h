@@ -0,0 +1,59 @@
+#pragma once
+
+// Geometry and framebuffer format of the display
+// Kept free of SDK headers, so that host tools can use it as well
+// Everything else about the layout is derived from the panel description below
+
+#include <stdint.h>
+
+// Size of a single panel
+#define DISPLAY_PANEL_WIDTH 32
+#define DISPLAY_PANEL_HEIGHT 32
+
+// Scan factor of the panels, e.g. 16 for 1/16 scan
+// Each row select lights one row in the upper and one in the lower half, so this has
+// to be half of DISPLAY_PANEL_HEIGHT: 1/8 for 16, 1/16 for 32 and 1/32 for 64 rows.
+// Panels that multiplex more rows per row select (e.g. 1/8 scan with 32 rows) are not supported
+#define DISPLAY_SCAN 16
+
+// Number of panels daisy-chained from the output of one to the input of the next
+// The chain is shifted like one wide panel, so they are placed next to each other
+#define DISPLAY_CHAIN_LENGTH 1
+
+// Integer between 1 and 8
+// Lower numbers cause LSBs to be skipped
+#define DISPLAY_BITDEPTH 8
+
+// Size of the whole display
+#define DISPLAY_WIDTH (DISPLAY_PANEL_WIDTH*DISPLAY_CHAIN_LENGTH)
+#define DISPLAY_HEIGHT DISPLAY_PANEL_HEIGHT
+
+static_assert(DISPLAY_PANEL_HEIGHT == 2*DISPLAY_SCAN, "Scan must be half of the panel height");
+static_assert(DISPLAY_SCAN >= 4 && DISPLAY_SCAN <= 32 && (DISPLAY_SCAN & (DISPLAY_SCAN-1)) == 0,
+              "Scan must be 1/4, 1/8, 1/16 or 1/32");
+
+// Row select pins used by the scan, A-B up to A-E
+#define DISPLAY_ROWSEL_COUNT (DISPLAY_SCAN > 16 ? 5 : DISPLAY_SCAN > 8 ? 4 : DISPLAY_SCAN > 4 ? 3 : 2)
+
+// Words between two rows of the scan in the pixel buffer, each holding pixels of both halves
+// Rounded up to a power of two, so that hub75_draw_pixel() needs no multiplication
+// This only wastes memory for widths that are not a power of two, e.g. chains of three panels
+#define DISPLAY_PIXEL_STRIDE (2*DISPLAY_WIDTH <= 64 ? 64 :   \
+                              2*DISPLAY_WIDTH <= 128 ? 128 : \
+                              2*DISPLAY_WIDTH <= 256 ? 256 : \
+                              2*DISPLAY_WIDTH <= 512 ? 512 : 1024)
+static_assert(2*DISPLAY_WIDTH <= DISPLAY_PIXEL_STRIDE, "Display too wide");
+
+// Amount of words in the pixel buffer
+#define DISPLAY_FRAMEBUFFER_SIZE (DISPLAY_SCAN*DISPLAY_PIXEL_STRIDE)
+
+// Pixel-pairs packed into each bitplane word, 6 bits each, see hub75_convert_word()
+// Must match the autopull threshold of the hub75_data PIO SM
+#define DISPLAY_PAIRS_PER_WORD 4
+
+// Words per row and bit level, pushed to the hub75_data PIO SM by DMA
+#define DISPLAY_PLANE_WORDS (DISPLAY_WIDTH/DISPLAY_PAIRS_PER_WORD)
+static_assert(DISPLAY_WIDTH % DISPLAY_PAIRS_PER_WORD == 0, "Rows must fill whole bitplane words");
+
+// Bitplanes of a whole frame, by row of the scan, bit level and pixel-pair
+typedef uint32_t display_planes_t[DISPLAY_SCAN][DISPLAY_BITDEPTH][DISPLAY_PLANE_WORDS];
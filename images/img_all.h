@@ -7,6 +7,7 @@
 #include "img_linrainbow.h"
 #include "img_maze.h"
 #include "img_rgbm.h"
+#include "img_sand.h"
 #include "img_single.h"
 #include "img_square8.h"
 #include "img_zigzag.h"
\ No newline at end of file
@@ -0,0 +1,705 @@
+#pragma once
+
+#include "pico/stdlib.h"
+
+// WARNING: This file has been autogenerated, do not edit directly!
+// Generated by png_to_header.py 0.2.0
+
+#define IMG_SAND_PARTICLE_COUNT 656
+
+const uint32_t IMG_SAND[] = {
+    0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 
+    0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 
+    0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 
+    0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 
+    0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 
+    0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 
+    0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 
+    0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 
+    0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 
+    0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 
+    0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 
+    0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 
+    0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 
+    0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 
+    0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 
+    0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 
+    0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 
+    0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 
+    0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 
+    0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 
+    0x00000000, 0x00000000, 0x00595959, 0x00595959, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00595959, 0x00595959, 0x00000000, 0x00000000, 
+    0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00595959, 0x00595959, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00595959, 0x00595959, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 
+    0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00595959, 0x00595959, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00595959, 0x00595959, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 
+    0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00595959, 0x00595959, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00595959, 0x00595959, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 
+    0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00595959, 0x00595959, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00595959, 0x00595959, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 
+    0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 
+    0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 
+    0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 
+    0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00595959, 0x00595959, 0x00595959, 0x00595959, 0x00595959, 0x00595959, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 
+    0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 
+    0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 
+    0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 0x00000000, 
+    
+};
+
+// Stored as x1, y1, color1, x2, y2, color2, ...
+// Could be a 2D Array, but the type of the list of different particle sets caused issues
+const uint32_t IMG_SAND_PARTICLES[IMG_SAND_PARTICLE_COUNT*3] = {
+    0, 0, 0x000000ff,
+    1, 0, 0x000000ff,
+    2, 0, 0x000000ff,
+    3, 0, 0x000000ff,
+    4, 0, 0x000000ff,
+    5, 0, 0x000000ff,
+    6, 0, 0x000000ff,
+    7, 0, 0x000000ff,
+    8, 0, 0x000000ff,
+    9, 0, 0x000000ff,
+    10, 0, 0x000000ff,
+    11, 0, 0x000000ff,
+    12, 0, 0x000000ff,
+    13, 0, 0x000000ff,
+    14, 0, 0x000000ff,
+    15, 0, 0x000000ff,
+    16, 0, 0x000000ff,
+    17, 0, 0x000000ff,
+    18, 0, 0x000000ff,
+    19, 0, 0x000000ff,
+    20, 0, 0x000000ff,
+    21, 0, 0x000000ff,
+    22, 0, 0x000000ff,
+    23, 0, 0x000000ff,
+    24, 0, 0x000000ff,
+    25, 0, 0x000000ff,
+    26, 0, 0x000000ff,
+    27, 0, 0x000000ff,
+    28, 0, 0x000000ff,
+    29, 0, 0x000000ff,
+    30, 0, 0x000000ff,
+    31, 0, 0x000000ff,
+    0, 1, 0x000000ff,
+    1, 1, 0x000000ff,
+    2, 1, 0x000000ff,
+    3, 1, 0x000000ff,
+    4, 1, 0x000000ff,
+    5, 1, 0x000000ff,
+    6, 1, 0x000000ff,
+    7, 1, 0x000000ff,
+    8, 1, 0x000000ff,
+    9, 1, 0x000000ff,
+    10, 1, 0x000000ff,
+    11, 1, 0x000000ff,
+    12, 1, 0x000000ff,
+    13, 1, 0x000000ff,
+    14, 1, 0x000000ff,
+    15, 1, 0x000000ff,
+    16, 1, 0x000000ff,
+    17, 1, 0x000000ff,
+    18, 1, 0x000000ff,
+    19, 1, 0x000000ff,
+    20, 1, 0x000000ff,
+    21, 1, 0x000000ff,
+    22, 1, 0x000000ff,
+    23, 1, 0x000000ff,
+    24, 1, 0x000000ff,
+    25, 1, 0x000000ff,
+    26, 1, 0x000000ff,
+    27, 1, 0x000000ff,
+    28, 1, 0x000000ff,
+    29, 1, 0x000000ff,
+    30, 1, 0x000000ff,
+    31, 1, 0x000000ff,
+    0, 2, 0x000000ff,
+    1, 2, 0x000000ff,
+    2, 2, 0x000000ff,
+    3, 2, 0x000000ff,
+    4, 2, 0x000000ff,
+    5, 2, 0x000000ff,
+    6, 2, 0x000000ff,
+    7, 2, 0x000000ff,
+    8, 2, 0x000000ff,
+    9, 2, 0x000000ff,
+    10, 2, 0x000000ff,
+    11, 2, 0x000000ff,
+    12, 2, 0x000000ff,
+    13, 2, 0x000000ff,
+    14, 2, 0x000000ff,
+    15, 2, 0x000000ff,
+    16, 2, 0x000000ff,
+    17, 2, 0x000000ff,
+    18, 2, 0x000000ff,
+    19, 2, 0x000000ff,
+    20, 2, 0x000000ff,
+    21, 2, 0x000000ff,
+    22, 2, 0x000000ff,
+    23, 2, 0x000000ff,
+    24, 2, 0x000000ff,
+    25, 2, 0x000000ff,
+    26, 2, 0x000000ff,
+    27, 2, 0x000000ff,
+    28, 2, 0x000000ff,
+    29, 2, 0x000000ff,
+    30, 2, 0x000000ff,
+    31, 2, 0x000000ff,
+    0, 3, 0x000084ff,
+    1, 3, 0x000084ff,
+    2, 3, 0x000084ff,
+    3, 3, 0x000084ff,
+    4, 3, 0x000084ff,
+    5, 3, 0x000084ff,
+    6, 3, 0x000084ff,
+    7, 3, 0x000084ff,
+    8, 3, 0x000084ff,
+    9, 3, 0x000084ff,
+    10, 3, 0x000084ff,
+    11, 3, 0x000084ff,
+    12, 3, 0x000084ff,
+    13, 3, 0x000084ff,
+    14, 3, 0x000084ff,
+    15, 3, 0x000084ff,
+    16, 3, 0x000084ff,
+    17, 3, 0x000084ff,
+    18, 3, 0x000084ff,
+    19, 3, 0x000084ff,
+    20, 3, 0x000084ff,
+    21, 3, 0x000084ff,
+    22, 3, 0x000084ff,
+    23, 3, 0x000084ff,
+    24, 3, 0x000084ff,
+    25, 3, 0x000084ff,
+    26, 3, 0x000084ff,
+    27, 3, 0x000084ff,
+    28, 3, 0x000084ff,
+    29, 3, 0x000084ff,
+    30, 3, 0x000084ff,
+    31, 3, 0x000084ff,
+    0, 4, 0x000084ff,
+    1, 4, 0x000084ff,
+    2, 4, 0x000084ff,
+    3, 4, 0x000084ff,
+    4, 4, 0x000084ff,
+    5, 4, 0x000084ff,
+    6, 4, 0x000084ff,
+    7, 4, 0x000084ff,
+    8, 4, 0x000084ff,
+    9, 4, 0x000084ff,
+    10, 4, 0x000084ff,
+    11, 4, 0x000084ff,
+    12, 4, 0x000084ff,
+    13, 4, 0x000084ff,
+    14, 4, 0x000084ff,
+    15, 4, 0x000084ff,
+    16, 4, 0x000084ff,
+    17, 4, 0x000084ff,
+    18, 4, 0x000084ff,
+    19, 4, 0x000084ff,
+    20, 4, 0x000084ff,
+    21, 4, 0x000084ff,
+    22, 4, 0x000084ff,
+    23, 4, 0x000084ff,
+    24, 4, 0x000084ff,
+    25, 4, 0x000084ff,
+    26, 4, 0x000084ff,
+    27, 4, 0x000084ff,
+    28, 4, 0x000084ff,
+    29, 4, 0x000084ff,
+    30, 4, 0x000084ff,
+    31, 4, 0x000084ff,
+    0, 5, 0x000084ff,
+    1, 5, 0x000084ff,
+    2, 5, 0x000084ff,
+    3, 5, 0x000084ff,
+    4, 5, 0x000084ff,
+    5, 5, 0x000084ff,
+    6, 5, 0x000084ff,
+    7, 5, 0x000084ff,
+    8, 5, 0x000084ff,
+    9, 5, 0x000084ff,
+    10, 5, 0x000084ff,
+    11, 5, 0x000084ff,
+    12, 5, 0x000084ff,
+    13, 5, 0x000084ff,
+    14, 5, 0x000084ff,
+    15, 5, 0x000084ff,
+    16, 5, 0x000084ff,
+    17, 5, 0x000084ff,
+    18, 5, 0x000084ff,
+    19, 5, 0x000084ff,
+    20, 5, 0x000084ff,
+    21, 5, 0x000084ff,
+    22, 5, 0x000084ff,
+    23, 5, 0x000084ff,
+    24, 5, 0x000084ff,
+    25, 5, 0x000084ff,
+    26, 5, 0x000084ff,
+    27, 5, 0x000084ff,
+    28, 5, 0x000084ff,
+    29, 5, 0x000084ff,
+    30, 5, 0x000084ff,
+    31, 5, 0x000084ff,
+    0, 6, 0x0000ff36,
+    1, 6, 0x0000ff36,
+    2, 6, 0x0000ff36,
+    3, 6, 0x0000ff36,
+    4, 6, 0x0000ff36,
+    5, 6, 0x0000ff36,
+    6, 6, 0x0000ff36,
+    7, 6, 0x0000ff36,
+    8, 6, 0x0000ff36,
+    9, 6, 0x0000ff36,
+    10, 6, 0x0000ff36,
+    11, 6, 0x0000ff36,
+    12, 6, 0x0000ff36,
+    13, 6, 0x0000ff36,
+    14, 6, 0x0000ff36,
+    15, 6, 0x0000ff36,
+    16, 6, 0x0000ff36,
+    17, 6, 0x0000ff36,
+    18, 6, 0x0000ff36,
+    19, 6, 0x0000ff36,
+    20, 6, 0x0000ff36,
+    21, 6, 0x0000ff36,
+    22, 6, 0x0000ff36,
+    23, 6, 0x0000ff36,
+    24, 6, 0x0000ff36,
+    25, 6, 0x0000ff36,
+    26, 6, 0x0000ff36,
+    27, 6, 0x0000ff36,
+    28, 6, 0x0000ff36,
+    29, 6, 0x0000ff36,
+    30, 6, 0x0000ff36,
+    31, 6, 0x0000ff36,
+    0, 7, 0x0000ff36,
+    1, 7, 0x0000ff36,
+    2, 7, 0x0000ff36,
+    3, 7, 0x0000ff36,
+    4, 7, 0x0000ff36,
+    5, 7, 0x0000ff36,
+    6, 7, 0x0000ff36,
+    7, 7, 0x0000ff36,
+    8, 7, 0x0000ff36,
+    9, 7, 0x0000ff36,
+    10, 7, 0x0000ff36,
+    11, 7, 0x0000ff36,
+    12, 7, 0x0000ff36,
+    13, 7, 0x0000ff36,
+    14, 7, 0x0000ff36,
+    15, 7, 0x0000ff36,
+    16, 7, 0x0000ff36,
+    17, 7, 0x0000ff36,
+    18, 7, 0x0000ff36,
+    19, 7, 0x0000ff36,
+    20, 7, 0x0000ff36,
+    21, 7, 0x0000ff36,
+    22, 7, 0x0000ff36,
+    23, 7, 0x0000ff36,
+    24, 7, 0x0000ff36,
+    25, 7, 0x0000ff36,
+    26, 7, 0x0000ff36,
+    27, 7, 0x0000ff36,
+    28, 7, 0x0000ff36,
+    29, 7, 0x0000ff36,
+    30, 7, 0x0000ff36,
+    31, 7, 0x0000ff36,
+    0, 8, 0x0000ff36,
+    1, 8, 0x0000ff36,
+    2, 8, 0x0000ff36,
+    3, 8, 0x0000ff36,
+    4, 8, 0x0000ff36,
+    5, 8, 0x0000ff36,
+    6, 8, 0x0000ff36,
+    7, 8, 0x0000ff36,
+    8, 8, 0x0000ff36,
+    9, 8, 0x0000ff36,
+    10, 8, 0x0000ff36,
+    11, 8, 0x0000ff36,
+    12, 8, 0x0000ff36,
+    13, 8, 0x0000ff36,
+    14, 8, 0x0000ff36,
+    15, 8, 0x0000ff36,
+    16, 8, 0x0000ff36,
+    17, 8, 0x0000ff36,
+    18, 8, 0x0000ff36,
+    19, 8, 0x0000ff36,
+    20, 8, 0x0000ff36,
+    21, 8, 0x0000ff36,
+    22, 8, 0x0000ff36,
+    23, 8, 0x0000ff36,
+    24, 8, 0x0000ff36,
+    25, 8, 0x0000ff36,
+    26, 8, 0x0000ff36,
+    27, 8, 0x0000ff36,
+    28, 8, 0x0000ff36,
+    29, 8, 0x0000ff36,
+    30, 8, 0x0000ff36,
+    31, 8, 0x0000ff36,
+    0, 9, 0x000cff00,
+    1, 9, 0x000cff00,
+    2, 9, 0x000cff00,
+    3, 9, 0x000cff00,
+    4, 9, 0x000cff00,
+    5, 9, 0x000cff00,
+    6, 9, 0x000cff00,
+    7, 9, 0x000cff00,
+    8, 9, 0x000cff00,
+    9, 9, 0x000cff00,
+    10, 9, 0x000cff00,
+    11, 9, 0x000cff00,
+    12, 9, 0x000cff00,
+    13, 9, 0x000cff00,
+    14, 9, 0x000cff00,
+    15, 9, 0x000cff00,
+    16, 9, 0x000cff00,
+    17, 9, 0x000cff00,
+    18, 9, 0x000cff00,
+    19, 9, 0x000cff00,
+    20, 9, 0x000cff00,
+    21, 9, 0x000cff00,
+    22, 9, 0x000cff00,
+    23, 9, 0x000cff00,
+    24, 9, 0x000cff00,
+    25, 9, 0x000cff00,
+    26, 9, 0x000cff00,
+    27, 9, 0x000cff00,
+    28, 9, 0x000cff00,
+    29, 9, 0x000cff00,
+    30, 9, 0x000cff00,
+    31, 9, 0x000cff00,
+    0, 10, 0x000cff00,
+    1, 10, 0x000cff00,
+    2, 10, 0x000cff00,
+    3, 10, 0x000cff00,
+    4, 10, 0x000cff00,
+    5, 10, 0x000cff00,
+    6, 10, 0x000cff00,
+    7, 10, 0x000cff00,
+    8, 10, 0x000cff00,
+    9, 10, 0x000cff00,
+    10, 10, 0x000cff00,
+    11, 10, 0x000cff00,
+    12, 10, 0x000cff00,
+    13, 10, 0x000cff00,
+    14, 10, 0x000cff00,
+    15, 10, 0x000cff00,
+    16, 10, 0x000cff00,
+    17, 10, 0x000cff00,
+    18, 10, 0x000cff00,
+    19, 10, 0x000cff00,
+    20, 10, 0x000cff00,
+    21, 10, 0x000cff00,
+    22, 10, 0x000cff00,
+    23, 10, 0x000cff00,
+    24, 10, 0x000cff00,
+    25, 10, 0x000cff00,
+    26, 10, 0x000cff00,
+    27, 10, 0x000cff00,
+    28, 10, 0x000cff00,
+    29, 10, 0x000cff00,
+    30, 10, 0x000cff00,
+    31, 10, 0x000cff00,
+    0, 11, 0x000cff00,
+    1, 11, 0x000cff00,
+    2, 11, 0x000cff00,
+    3, 11, 0x000cff00,
+    4, 11, 0x000cff00,
+    5, 11, 0x000cff00,
+    6, 11, 0x000cff00,
+    7, 11, 0x000cff00,
+    8, 11, 0x000cff00,
+    9, 11, 0x000cff00,
+    10, 11, 0x000cff00,
+    11, 11, 0x000cff00,
+    12, 11, 0x000cff00,
+    13, 11, 0x000cff00,
+    14, 11, 0x000cff00,
+    15, 11, 0x000cff00,
+    16, 11, 0x000cff00,
+    17, 11, 0x000cff00,
+    18, 11, 0x000cff00,
+    19, 11, 0x000cff00,
+    20, 11, 0x000cff00,
+    21, 11, 0x000cff00,
+    22, 11, 0x000cff00,
+    23, 11, 0x000cff00,
+    24, 11, 0x000cff00,
+    25, 11, 0x000cff00,
+    26, 11, 0x000cff00,
+    27, 11, 0x000cff00,
+    28, 11, 0x000cff00,
+    29, 11, 0x000cff00,
+    30, 11, 0x000cff00,
+    31, 11, 0x000cff00,
+    0, 12, 0x00ffff00,
+    1, 12, 0x00ffff00,
+    2, 12, 0x00ffff00,
+    3, 12, 0x00ffff00,
+    4, 12, 0x00ffff00,
+    5, 12, 0x00ffff00,
+    6, 12, 0x00ffff00,
+    7, 12, 0x00ffff00,
+    8, 12, 0x00ffff00,
+    9, 12, 0x00ffff00,
+    10, 12, 0x00ffff00,
+    11, 12, 0x00ffff00,
+    12, 12, 0x00ffff00,
+    13, 12, 0x00ffff00,
+    14, 12, 0x00ffff00,
+    15, 12, 0x00ffff00,
+    16, 12, 0x00ffff00,
+    17, 12, 0x00ffff00,
+    18, 12, 0x00ffff00,
+    19, 12, 0x00ffff00,
+    20, 12, 0x00ffff00,
+    21, 12, 0x00ffff00,
+    22, 12, 0x00ffff00,
+    23, 12, 0x00ffff00,
+    24, 12, 0x00ffff00,
+    25, 12, 0x00ffff00,
+    26, 12, 0x00ffff00,
+    27, 12, 0x00ffff00,
+    28, 12, 0x00ffff00,
+    29, 12, 0x00ffff00,
+    30, 12, 0x00ffff00,
+    31, 12, 0x00ffff00,
+    0, 13, 0x00ffff00,
+    1, 13, 0x00ffff00,
+    2, 13, 0x00ffff00,
+    3, 13, 0x00ffff00,
+    4, 13, 0x00ffff00,
+    5, 13, 0x00ffff00,
+    6, 13, 0x00ffff00,
+    7, 13, 0x00ffff00,
+    8, 13, 0x00ffff00,
+    9, 13, 0x00ffff00,
+    10, 13, 0x00ffff00,
+    11, 13, 0x00ffff00,
+    12, 13, 0x00ffff00,
+    13, 13, 0x00ffff00,
+    14, 13, 0x00ffff00,
+    15, 13, 0x00ffff00,
+    16, 13, 0x00ffff00,
+    17, 13, 0x00ffff00,
+    18, 13, 0x00ffff00,
+    19, 13, 0x00ffff00,
+    20, 13, 0x00ffff00,
+    21, 13, 0x00ffff00,
+    22, 13, 0x00ffff00,
+    23, 13, 0x00ffff00,
+    24, 13, 0x00ffff00,
+    25, 13, 0x00ffff00,
+    26, 13, 0x00ffff00,
+    27, 13, 0x00ffff00,
+    28, 13, 0x00ffff00,
+    29, 13, 0x00ffff00,
+    30, 13, 0x00ffff00,
+    31, 13, 0x00ffff00,
+    0, 14, 0x00ffff00,
+    1, 14, 0x00ffff00,
+    2, 14, 0x00ffff00,
+    3, 14, 0x00ffff00,
+    4, 14, 0x00ffff00,
+    5, 14, 0x00ffff00,
+    6, 14, 0x00ffff00,
+    7, 14, 0x00ffff00,
+    8, 14, 0x00ffff00,
+    9, 14, 0x00ffff00,
+    10, 14, 0x00ffff00,
+    11, 14, 0x00ffff00,
+    12, 14, 0x00ffff00,
+    13, 14, 0x00ffff00,
+    14, 14, 0x00ffff00,
+    15, 14, 0x00ffff00,
+    16, 14, 0x00ffff00,
+    17, 14, 0x00ffff00,
+    18, 14, 0x00ffff00,
+    19, 14, 0x00ffff00,
+    20, 14, 0x00ffff00,
+    21, 14, 0x00ffff00,
+    22, 14, 0x00ffff00,
+    23, 14, 0x00ffff00,
+    24, 14, 0x00ffff00,
+    25, 14, 0x00ffff00,
+    26, 14, 0x00ffff00,
+    27, 14, 0x00ffff00,
+    28, 14, 0x00ffff00,
+    29, 14, 0x00ffff00,
+    30, 14, 0x00ffff00,
+    31, 14, 0x00ffff00,
+    0, 15, 0x00ff0c00,
+    1, 15, 0x00ff0c00,
+    2, 15, 0x00ff0c00,
+    3, 15, 0x00ff0c00,
+    4, 15, 0x00ff0c00,
+    5, 15, 0x00ff0c00,
+    6, 15, 0x00ff0c00,
+    7, 15, 0x00ff0c00,
+    8, 15, 0x00ff0c00,
+    9, 15, 0x00ff0c00,
+    10, 15, 0x00ff0c00,
+    11, 15, 0x00ff0c00,
+    12, 15, 0x00ff0c00,
+    13, 15, 0x00ff0c00,
+    14, 15, 0x00ff0c00,
+    15, 15, 0x00ff0c00,
+    16, 15, 0x00ff0c00,
+    17, 15, 0x00ff0c00,
+    18, 15, 0x00ff0c00,
+    19, 15, 0x00ff0c00,
+    20, 15, 0x00ff0c00,
+    21, 15, 0x00ff0c00,
+    22, 15, 0x00ff0c00,
+    23, 15, 0x00ff0c00,
+    24, 15, 0x00ff0c00,
+    25, 15, 0x00ff0c00,
+    26, 15, 0x00ff0c00,
+    27, 15, 0x00ff0c00,
+    28, 15, 0x00ff0c00,
+    29, 15, 0x00ff0c00,
+    30, 15, 0x00ff0c00,
+    31, 15, 0x00ff0c00,
+    0, 16, 0x00ff0c00,
+    1, 16, 0x00ff0c00,
+    2, 16, 0x00ff0c00,
+    3, 16, 0x00ff0c00,
+    4, 16, 0x00ff0c00,
+    5, 16, 0x00ff0c00,
+    6, 16, 0x00ff0c00,
+    7, 16, 0x00ff0c00,
+    8, 16, 0x00ff0c00,
+    9, 16, 0x00ff0c00,
+    10, 16, 0x00ff0c00,
+    11, 16, 0x00ff0c00,
+    12, 16, 0x00ff0c00,
+    13, 16, 0x00ff0c00,
+    14, 16, 0x00ff0c00,
+    15, 16, 0x00ff0c00,
+    16, 16, 0x00ff0c00,
+    17, 16, 0x00ff0c00,
+    18, 16, 0x00ff0c00,
+    19, 16, 0x00ff0c00,
+    20, 16, 0x00ff0c00,
+    21, 16, 0x00ff0c00,
+    22, 16, 0x00ff0c00,
+    23, 16, 0x00ff0c00,
+    24, 16, 0x00ff0c00,
+    25, 16, 0x00ff0c00,
+    26, 16, 0x00ff0c00,
+    27, 16, 0x00ff0c00,
+    28, 16, 0x00ff0c00,
+    29, 16, 0x00ff0c00,
+    30, 16, 0x00ff0c00,
+    31, 16, 0x00ff0c00,
+    0, 17, 0x00ff0c00,
+    1, 17, 0x00ff0c00,
+    2, 17, 0x00ff0c00,
+    3, 17, 0x00ff0c00,
+    4, 17, 0x00ff0c00,
+    5, 17, 0x00ff0c00,
+    6, 17, 0x00ff0c00,
+    7, 17, 0x00ff0c00,
+    8, 17, 0x00ff0c00,
+    9, 17, 0x00ff0c00,
+    10, 17, 0x00ff0c00,
+    11, 17, 0x00ff0c00,
+    12, 17, 0x00ff0c00,
+    13, 17, 0x00ff0c00,
+    14, 17, 0x00ff0c00,
+    15, 17, 0x00ff0c00,
+    16, 17, 0x00ff0c00,
+    17, 17, 0x00ff0c00,
+    18, 17, 0x00ff0c00,
+    19, 17, 0x00ff0c00,
+    20, 17, 0x00ff0c00,
+    21, 17, 0x00ff0c00,
+    22, 17, 0x00ff0c00,
+    23, 17, 0x00ff0c00,
+    24, 17, 0x00ff0c00,
+    25, 17, 0x00ff0c00,
+    26, 17, 0x00ff0c00,
+    27, 17, 0x00ff0c00,
+    28, 17, 0x00ff0c00,
+    29, 17, 0x00ff0c00,
+    30, 17, 0x00ff0c00,
+    31, 17, 0x00ff0c00,
+    0, 18, 0x00ff0036,
+    1, 18, 0x00ff0036,
+    2, 18, 0x00ff0036,
+    3, 18, 0x00ff0036,
+    4, 18, 0x00ff0036,
+    5, 18, 0x00ff0036,
+    6, 18, 0x00ff0036,
+    7, 18, 0x00ff0036,
+    8, 18, 0x00ff0036,
+    9, 18, 0x00ff0036,
+    10, 18, 0x00ff0036,
+    11, 18, 0x00ff0036,
+    12, 18, 0x00ff0036,
+    13, 18, 0x00ff0036,
+    14, 18, 0x00ff0036,
+    15, 18, 0x00ff0036,
+    16, 18, 0x00ff0036,
+    17, 18, 0x00ff0036,
+    18, 18, 0x00ff0036,
+    19, 18, 0x00ff0036,
+    20, 18, 0x00ff0036,
+    21, 18, 0x00ff0036,
+    22, 18, 0x00ff0036,
+    23, 18, 0x00ff0036,
+    24, 18, 0x00ff0036,
+    25, 18, 0x00ff0036,
+    26, 18, 0x00ff0036,
+    27, 18, 0x00ff0036,
+    28, 18, 0x00ff0036,
+    29, 18, 0x00ff0036,
+    30, 18, 0x00ff0036,
+    31, 18, 0x00ff0036,
+    0, 19, 0x00ff0036,
+    1, 19, 0x00ff0036,
+    2, 19, 0x00ff0036,
+    3, 19, 0x00ff0036,
+    4, 19, 0x00ff0036,
+    5, 19, 0x00ff0036,
+    6, 19, 0x00ff0036,
+    7, 19, 0x00ff0036,
+    8, 19, 0x00ff0036,
+    9, 19, 0x00ff0036,
+    10, 19, 0x00ff0036,
+    11, 19, 0x00ff0036,
+    12, 19, 0x00ff0036,
+    13, 19, 0x00ff0036,
+    14, 19, 0x00ff0036,
+    15, 19, 0x00ff0036,
+    16, 19, 0x00ff0036,
+    17, 19, 0x00ff0036,
+    18, 19, 0x00ff0036,
+    19, 19, 0x00ff0036,
+    20, 19, 0x00ff0036,
+    21, 19, 0x00ff0036,
+    22, 19, 0x00ff0036,
+    23, 19, 0x00ff0036,
+    24, 19, 0x00ff0036,
+    25, 19, 0x00ff0036,
+    26, 19, 0x00ff0036,
+    27, 19, 0x00ff0036,
+    28, 19, 0x00ff0036,
+    29, 19, 0x00ff0036,
+    30, 19, 0x00ff0036,
+    31, 19, 0x00ff0036,
+    12, 20, 0x00ff0036,
+    13, 20, 0x00ff0036,
+    14, 20, 0x00ff0036,
+    15, 20, 0x00ff0036,
+    16, 20, 0x00ff0036,
+    17, 20, 0x00ff0036,
+    18, 20, 0x00ff0036,
+    19, 20, 0x00ff0036,
+    12, 21, 0x008400ff,
+    13, 21, 0x008400ff,
+    14, 21, 0x008400ff,
+    15, 21, 0x008400ff,
+    16, 21, 0x008400ff,
+    17, 21, 0x008400ff,
+    18, 21, 0x008400ff,
+    19, 21, 0x008400ff,
+};
@@ -3,6 +3,7 @@
 #include "MPU6050.h"
 #include "hub75.h"
 #include "simulation.h"
+#include "sand.h"
 
 #include "images/img_all.h"
 #include "gol/gol_all.h"
@@ -18,7 +19,7 @@
 /*
  * Background image format
  *
- * Backgrounds are represented as a flat array of DISPLAY_SIZE**2 uint32_t
+ * Backgrounds are represented as a flat array of DISPLAY_WIDTH*DISPLAY_HEIGHT uint32_t
  *
  * Each uint32_t represents a pixel, with components 0xAABBGGRR.
  *
@@ -56,16 +57,28 @@ bool btn_reset_pressed = false;
 
 int cur_stage = 0;
 
-Simulation sim(DISPLAY_SIZE, DISPLAY_SIZE,
-               MPU_SCALE, SIM_MAX_PARTICLECOUNT, SIM_ELASTICITY, true
-               );
+Simulation<DISPLAY_WIDTH, DISPLAY_HEIGHT, SIM_MAX_PARTICLECOUNT> sim(
+        MPU_SCALE, SIM_ELASTICITY, SIM_SORTMODE_INCREMENTAL
+        );
+
+Sand<DISPLAY_WIDTH, DISPLAY_HEIGHT> sand(MPU_SCALE);
 
 Snake snake;
 GameOfLife gol;
 
-uint32_t anim_framebuf[32*32];
+uint32_t anim_framebuf[DISPLAY_HEIGHT*DISPLAY_WIDTH];
+
+// Display owns no buffer and waits for the next redraw request
+bool display_idle = false;
+
+// Copy of the palette of the current stage, handed to the display with the particles
+// Loading a stage rewrites the palette of the engine, which the display might be drawing with
+uint32_t display_palette_copy[SIM_MAX_COLORCOUNT > SAND_MAX_COLORCOUNT ? SIM_MAX_COLORCOUNT : SAND_MAX_COLORCOUNT];
 
 void start_stage();
+bool display_acquire(uint32_t timeout_us);
+void display_release();
+void physics_step();
 
 void print_statusinfo() {
     printf("Accel: X = % 1.8fg, Y = % 1.8fg, Z = % 1.8fg\n", mpu.ax, mpu.ay, mpu.az);
@@ -89,8 +102,8 @@ void gol_draw(uint32_t frame) {
     absolute_time_t te = get_absolute_time();
 
     int count = 0;
-    for (int x = 0; x < DISPLAY_SIZE; ++x) {
-        for (int y = 0; y < DISPLAY_SIZE; ++y) {
+    for (int x = 0; x < DISPLAY_WIDTH; ++x) {
+        for (int y = 0; y < DISPLAY_HEIGHT; ++y) {
 
             if (gol.universe[y][x]) {
                 count++;
@@ -234,8 +247,47 @@ void draw_anim(int id, uint32_t frame) {
     }
 }
 
+bool display_acquire(uint32_t timeout_us) {
+    // Take the token the display sends back after each redraw, true if it is idle
+    // The token is kept until display_release(), so this can be polled
+    if (!display_idle) {
+        uint32_t fifo_out = 0;
+        display_idle = multicore_fifo_pop_timeout_us(timeout_us, &fifo_out);
+    }
+    return display_idle;
+}
+
+void display_release() {
+    // Hand the token back with a redraw request, only after display_acquire() succeeded
+    display_idle = false;
+    multicore_fifo_push_blocking(DISPLAY_TRIGGER_REDRAW_MAGIC_NUMBER);
+}
+
+void physics_step() {
+    // Advance the current stage by one fixed timestep of 1/PHYSICS_TPS seconds
+    if (stages[cur_stage].engine == STAGE_ENGINE_SAND) {
+        sand.scale = stages[cur_stage].scale;
+        sand.iterate((int) (mpu.ayn * PHYSICS_PRESCALE), (int) (mpu.axn * PHYSICS_PRESCALE),
+                     (int) (mpu.azn * PHYSICS_PRESCALE));
+    } else {
+        // Copy parameters from config struct
+        sim.scale = stages[cur_stage].scale;
+        sim.elasticity = stages[cur_stage].elasticity;
+        sim.rand = stages[cur_stage].rand;
+        sim.speed = stages[cur_stage].speed;
+
+        // Step the simulation
+        sim.iterate((int) (mpu.ayn * PHYSICS_PRESCALE), (int) (mpu.axn * PHYSICS_PRESCALE),
+                    (int) (mpu.azn * PHYSICS_PRESCALE));
+    }
+}
+
 void start_stage() {
-    if (cur_stage < STAGE_COUNT) {
+    if (cur_stage < STAGE_COUNT && stages[cur_stage].engine == STAGE_ENGINE_SAND) {
+        sand.clearAll();
+        sand.loadBackground(stages[cur_stage].bg);
+        sand.loadParticles(stages[cur_stage].particles, stages[cur_stage].particlecount);
+    } else if (cur_stage < STAGE_COUNT) {
         sim.clearAll();
         sim.loadBackground(stages[cur_stage].bg);
         sim.loadParticles(stages[cur_stage].particles, stages[cur_stage].particlecount);
@@ -289,6 +341,10 @@ int main()
     // Initialize HUB75
     hub75_init();
 
+    // Let the HUB75 driver on core1 help with the simulation while it waits for the PIO
+    worksplit_init(&display_worksplit);
+    sim.split = &display_worksplit;
+
     // Launch matrix driver main loop
     multicore_launch_core1(hub75_main);
     sleep_ms(100);  // Sleep a bit to allow for proper initialization of HUB75 driver main loop
@@ -311,11 +367,23 @@ int main()
     absolute_time_t btn_reset_last = get_absolute_time();
     absolute_time_t btn_select_last = get_absolute_time();
 
+    // Fixed timestep scheduler of the physics, see PHYSICS_TPS
+    absolute_time_t physics_time = get_absolute_time();
+    int64_t physics_lag = 0;  // Real time not simulated yet, in us
+    uint32_t physics_steps = 0, physics_dropped = 0;
+    int64_t mpu_us = 0, step_us = 0;
+    uint32_t step_batch = 1;  // Steps timed by step_us
+
+    // Refresh rate of the display, measured over the time between status lines
+    absolute_time_t refresh_time = get_absolute_time();
+    uint32_t refresh_count = display_refreshes;
+
     if (!btn_select_pressed && !btn_reset_pressed) {
         // Enter diagnosis mode
 
         // Set up animation framebuffer for rendering
         display_background = anim_framebuf;
+        display_fullredraw = true;
         display_particlecount = 0;
 
         // Draw code
@@ -327,9 +395,8 @@ int main()
         // TODO: add real-time text diagnostics, e.g. MPU readouts
 
         // Trigger redraw, also consume FIFO token
-        uint32_t fifo_out = 0;
-        multicore_fifo_pop_timeout_us(FIFO_TIMEOUT, &fifo_out);
-        multicore_fifo_push_blocking(DISPLAY_TRIGGER_REDRAW_MAGIC_NUMBER);
+        display_acquire(FIFO_TIMEOUT);
+        display_release();
 
         // Sleep forever, since diagnosis mode is non-interactive
         while (true) {
@@ -371,8 +438,56 @@ int main()
             btn_select_pressed = gpio_get(BTN_SELECT_PIN);
         }
 
+        // Physics runs on its own clock, with as many fixed steps as are due
+        absolute_time_t now = get_absolute_time();
+        if (cur_stage < STAGE_COUNT) {
+            physics_lag += absolute_time_diff_us(physics_time, now);
+            physics_time = now;
+            if (physics_lag > PHYSICS_MAX_STEPS*PHYSICS_STEP_US) {
+                // Fell behind, e.g. after a stage change, slow down instead of catching up
+                physics_lag = PHYSICS_MAX_STEPS*PHYSICS_STEP_US;
+                physics_dropped++;
+            }
+
+            if (physics_lag >= PHYSICS_STEP_US) {
+                // Update MPU6050, results are available as attributes
+                // Once for all steps that are due, since it is quite slow
+                // TODO: improve performance of MPU update, since it is currently quite slow
+                absolute_time_t t1 = get_absolute_time();
+                mpu.update();
+                absolute_time_t t2 = get_absolute_time();
+
+                step_batch = 0;
+                while (physics_lag >= PHYSICS_STEP_US) {
+                    physics_step();
+                    physics_lag -= PHYSICS_STEP_US;
+                    physics_steps++;
+                    step_batch++;
+                }
+
+                mpu_us = absolute_time_diff_us(t1, t2);
+                step_us = absolute_time_diff_us(t2, get_absolute_time());
+            }
+        } else {
+            physics_time = now;
+            physics_lag = 0;
+        }
+
         // Limit frame rate if we are too fast
         if (time_reached(delayed_by_ms(frame_time, 1000/TPS))) {
+            if (cur_stage < STAGE_COUNT) {
+                // Present the latest physics state, but never wait for the display
+                // A slow redraw only delays the next frame, the physics keeps running
+                if (!display_acquire(0)) {
+                    if (time_reached(delayed_by_us(frame_time, FIFO_TIMEOUT))) {
+                        printf("ERROR: Timed out while waiting for HUB75 driver to finish redrawing!\n");
+                        frame_time = get_absolute_time();
+                    }
+                    last_loop_rendered = false;
+                    continue;
+                }
+            }
+
             frame_time = get_absolute_time();
 
             // Simple over-utilization detection with rate limited warnings
@@ -386,77 +501,90 @@ int main()
             }
 
             if (cur_stage < STAGE_COUNT) {
-                // Process / Render simulation
-
-                // Update MPU6050, results are available as attributes
-                // TODO: improve performance of MPU update, since it is currently quite slow
-                mpu.update();
-
                 if (frame % (TPS / 1) == 0) {
                     print_statusinfo();
                 }
 
-                absolute_time_t t2 = get_absolute_time();
-
-                // Copy parameters from config struct
-                sim.scale = stages[cur_stage].scale;
-                sim.elasticity = stages[cur_stage].elasticity;
-                sim.rand = stages[cur_stage].rand;
-
-                // Step the simulation
-                sim.iterate((int) (mpu.ayn * MPU_PRESCALE), (int) (mpu.axn * MPU_PRESCALE),
-                            (int) (mpu.azn * MPU_PRESCALE));
-
-                absolute_time_t t3 = get_absolute_time();
-
-                // Wait until previous timestep is done rendering
-                // Usually only a few microseconds
-                uint32_t fifo_out = 0;
-                if (!multicore_fifo_pop_timeout_us(FIFO_TIMEOUT, &fifo_out)) {
-                    printf("ERROR: Timed out while waiting for HUB75 driver to finish redrawing!\n");
-                    last_loop_rendered = false;
-                    continue;  // Skip frame, because our outbound FIFO would fill up otherwise
+                // Hand over the particles of the last step, no copy needed
+                // The display is done with the previous buffer, since it acknowledged the redraw
+                bool sandstage = stages[cur_stage].engine == STAGE_ENGINE_SAND;
+                if (sandstage) {
+                    display_particles = sand.publish();
+                    memcpy(display_palette_copy, sand.palette, sand.palettesize*sizeof(uint32_t));
+                    display_particlecount = sand.particlecount;
+                } else {
+                    display_particles = sim.publish();
+                    memcpy(display_palette_copy, sim.palette, sim.palettesize*sizeof(uint32_t));
+                    display_particlecount = sim.particlecount;
                 }
-
-                absolute_time_t t4 = get_absolute_time();
-
-                // Copy over particle data
-                // memcpy should use pico-optimized variant and be relatively fast
-                memcpy(&display_particles, &sim.particles, sizeof(particle_t) * sim.particlecount);
-                display_particlecount = sim.particlecount;
+                display_palette = display_palette_copy;
 
                 // Update background reference and trigger redraw by signalling other core
                 display_background = stages[cur_stage].bg;
-                multicore_fifo_push_blocking(DISPLAY_TRIGGER_REDRAW_MAGIC_NUMBER);
+                display_release();
 
                 frame++;
                 last_loop_rendered = true;
 
-                absolute_time_t t5 = get_absolute_time();
-
-                // Performance measurements
-                if (frame % (TPS / 1) == 0) {
-                    printf("MPU=%lldus SIM=%lldus FIFO=%lldus COPY=%lldus\n",
-                           absolute_time_diff_us(frame_time, t2),
-                           absolute_time_diff_us(t2, t3),
-                           absolute_time_diff_us(t3, t4),
-                           absolute_time_diff_us(t4, t5)
+                // Performance measurements, timings are of the last batch of steps
+                // SIM and SAND are per step, averaged over the BATCH steps of that batch
+                if (frame % (TPS / 1) == 0 && sandstage) {
+                    printf("MPU=%lldus SAND=%lldus BATCH=%lu (MOVED=%lu) STEPS=%lu DROPPED=%lu\n",
+                           mpu_us,
+                           step_us / step_batch,
+                           step_batch,
+                           sand.movedcount,
+                           physics_steps,
+                           physics_dropped
+                    );
+                } else if (frame % (TPS / 1) == 0) {
+                    printf("MPU=%lldus SIM=%lldus BATCH=%lu (SORT=%luus REST=%lu HELP=%lu) STEPS=%lu DROPPED=%lu\n",
+                           mpu_us,
+                           step_us / step_batch,
+                           step_batch,
+                           sim.sorttime,
+                           sim.sleepingcount,
+                           display_worksplit.helped,
+                           physics_steps,
+                           physics_dropped
                     );
+#if SIM_STATS
+                    printf("MOVED=%lu WALLS=%lu COLL=%lu DIAG=%lu CLAMP=%lu SORTMOVES=%lu\n",
+                           sim.stats.moved,
+                           sim.stats.walls,
+                           sim.stats.collisions,
+                           sim.stats.diagonals,
+                           sim.stats.clamps,
+                           sim.stats.sortmoves
+                    );
+#endif
+                }
+                if (frame % (TPS / 1) == 0) {
+#if !DISPLAY_DMA_CHAIN
+                    uint32_t refreshes = display_refreshes;
+                    int64_t refresh_us = absolute_time_diff_us(refresh_time, get_absolute_time());
+                    printf("REFRESH=%lluHz\n", (refreshes - refresh_count) * 1000000ull / refresh_us);
+                    refresh_time = get_absolute_time();
+                    refresh_count = refreshes;
+#endif
+                    physics_steps = 0;
+                    physics_dropped = 0;
                 }
 
             } else {
                 // Wait until previous frame is done rendering
                 // Usually only a few microseconds, but may be more since
                 // animations render quite fast and we don't have to wait for the MPU
-                uint32_t fifo_out = 0;
-                if (!multicore_fifo_pop_timeout_us(FIFO_TIMEOUT, &fifo_out)) {
+                if (!display_acquire(FIFO_TIMEOUT)) {
                     printf("ERROR: Timed out while waiting for HUB75 driver to finish redrawing!\n");
                     last_loop_rendered = false;
                     continue;  // Skip frame, because our outbound FIFO would fill up otherwise
                 }
 
                 // Configure HUB75 driver to draw from framebuffer
+                // The framebuffer is redrawn in place, so the display has to copy all of it
                 display_background = anim_framebuf;
+                display_fullredraw = true;
                 display_particlecount = 0;  // Animations could override this, but must do so every frame
 
                 // Render animation / GoL
@@ -467,7 +595,7 @@ int main()
                 }
 
                 // Signal other core that we are done
-                multicore_fifo_push_blocking(DISPLAY_TRIGGER_REDRAW_MAGIC_NUMBER);
+                display_release();
 
                 frame++;
                 last_loop_rendered = true;
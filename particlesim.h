@@ -13,6 +13,7 @@
 #include "hardware/timer.h"
 #include "hardware/gpio.h"
 
+#include "hub75_geometry.h"
 #include "anim_helpers.h"
 
 #define VERSION "0.1"
@@ -23,6 +24,17 @@
 
 #define MPU_SCALE 32
 #define MPU_PRESCALE (48.0f)
+
+// Physics rate of the stages, independent of the display rate TPS
+// Stages are tuned for 120 steps per second, the input scaling keeps the motion
+// in cells per second the same at other rates, e.g. 240
+#define PHYSICS_TPS TPS
+#define PHYSICS_STEP_US (1000000/PHYSICS_TPS)
+#define PHYSICS_PRESCALE (MPU_PRESCALE*TPS*TPS/(PHYSICS_TPS*PHYSICS_TPS))
+
+// Most physics steps run back to back when catching up, any further backlog is dropped
+// Keeps the physics from spiralling when a step takes longer than PHYSICS_STEP_US
+#define PHYSICS_MAX_STEPS 4
 #define SIM_ELASTICITY 170
 
 #define BTN_SELECT_PIN 2
@@ -33,17 +45,22 @@
 // It would be better to use hardware debouncing with an RC-Filter
 #define BTN_DEBOUNCE_MS 250
 
-#define DISPLAY_WIDTH 32
-#define DISPLAY_HEIGHT 32
-
 extern uint32_t anim_framebuf[DISPLAY_HEIGHT*DISPLAY_WIDTH];
 
+// Engine that moves the particles of a stage
+enum STAGE_ENGINE {
+    STAGE_ENGINE_PARTICLES,  // Simulation, particles with position and velocity
+    STAGE_ENGINE_SAND,  // Sand, grains on a bitmap, supports a full screen
+};
+
 typedef struct stage {
+    const STAGE_ENGINE engine;
     const uint32_t* bg;
     const uint32_t* particles;
     const uint32_t particlecount;
     const uint8_t scale, elasticity;
     const bool rand;
+    const uint8_t speed;  // Maximum speed in cells per tick
 } stage_t;
 
 typedef struct universe {
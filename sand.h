@@ -0,0 +1,378 @@
+#pragma once
+
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+
+#include "simulation.h"
+
+// Maximum number of distinct grain colors per stage
+#define SAND_MAX_COLORCOUNT 256
+
+
+/*
+ * Falling sand on a grid of W x H cells
+ *
+ * Unlike Simulation, grains have no position or velocity of their own. Each grain is
+ * a bit in the row bitmap, and all grains of a row are moved at once with a few
+ * bitwise operations, so the cost depends on the number of rows rather than the
+ * number of grains. This makes a completely full screen possible.
+ * The color of every cell is kept in a separate layer and only touched for grains
+ * that actually moved.
+ *
+ * Every tick, the acceleration is reduced to one of eight directions. Each grain
+ * then moves at most one cell: straight ahead if that cell is free, otherwise
+ * diagonally to either side. Rows are processed front to back, so a grain can move
+ * into a cell that was freed by the grain in front of it during the same tick.
+ * Columns of sand therefore fall as one.
+ *
+ * Everything is deterministic, so once no grain moved and the direction is
+ * unchanged, nothing will move until the direction changes.
+ */
+template<uint32_t W, uint32_t H>
+class Sand {
+public:
+    static constexpr uint32_t width = W;
+    static constexpr uint32_t height = H;
+    static constexpr uint32_t maxParticles = W*H;
+
+    explicit Sand(uint8_t scale);
+
+    void loadBackground(const uint32_t* bg);
+    void loadParticles(const uint32_t* p, uint32_t count);
+
+    inline bool getPixel(uint32_t x, uint32_t y) const;
+
+    void clearAll();
+
+    void iterate(int32_t ax, int32_t ay, int32_t az);
+
+    // Same as Simulation::publish()
+    const particle_cell_t* publish();
+
+    uint32_t particlecount;
+
+    uint8_t colors[H*W];  // Index into palette for every cell, only valid where a grain is
+
+    uint32_t palette[SAND_MAX_COLORCOUNT];  // RGB Colors of the grains
+    uint32_t palettesize;
+
+    uint8_t scale;
+
+    // Number of grains that moved during the last call to iterate()
+    uint32_t movedcount;
+
+private:
+    // Rows are stored as whole words, the leftmost cell is the MSB of the first word
+    static constexpr uint32_t w32 = W/32;
+
+    static_assert(W % 32 == 0, "Rows are stored as whole words");
+    static_assert(W <= 256 && H <= 256, "Cells are published as 8-bit coordinates");
+
+    uint8_t paletteIndex(uint32_t color);
+
+    inline void moveRow(uint32_t y, int32_t dx, int32_t dy, uint32_t* cand);
+    void updateCells();
+
+    uint32_t grains[H*w32];
+    uint32_t obstacles[H*w32];
+    uint32_t arrived[H*w32];  // Grains that already moved during the current tick
+
+    uint32_t tick;
+    int8_t lastdir;  // Direction of the last tick, -1 if none
+    bool settled;    // Nothing moved during the last tick
+
+    // Double-buffered output for the display, see Simulation::publish()
+    particle_cell_t cells[2][W*H];
+    uint8_t cellslatest;
+    int8_t cellsshown;
+    bool cellsdirty;  // Grains changed since the cells were last written
+};
+
+// The eight directions, counterclockwise starting at +x
+// Same order as the directions used for sorting in Simulation
+static const int8_t sand_dirs[8][2] = {
+        { 1,  0}, { 1,  1}, { 0,  1}, {-1,  1},
+        {-1,  0}, {-1, -1}, { 0, -1}, { 1, -1},
+};
+
+template<uint32_t W, uint32_t H>
+Sand<W, H>::Sand(uint8_t scale)
+    : particlecount(0), colors{}, palette{}, palettesize(0), scale(scale), movedcount(0),
+    grains{}, obstacles{}, arrived{}, tick(0), lastdir(-1), settled(false),
+    cells{}, cellslatest(0), cellsshown(-1), cellsdirty(true)
+    {}
+
+template<uint32_t W, uint32_t H>
+void Sand<W, H>::loadBackground(const uint32_t *bg) {
+    // Copy obstacles from image
+    for (int x = 0; x < width; ++x) {
+        for (int y = 0; y < height; ++y) {
+            // If non-black pixel, mark as obstacle
+            if (bg[y*width+x]!=0) {
+                obstacles[y*w32 + x/32] |= 0x80000000 >> (x%32);
+            }
+        }
+    }
+    settled = false;
+}
+
+template<uint32_t W, uint32_t H>
+void Sand<W, H>::loadParticles(const uint32_t *p, uint32_t count) {
+    if (count > W*H) {
+        panic("Too many particles!\n");
+    }
+    particlecount = count;
+    palettesize = 0;
+    for (int i = 0; i < particlecount; ++i) {
+        uint32_t x = p[i*3], y = p[i*3+1];
+        grains[y*w32 + x/32] |= 0x80000000 >> (x%32);
+        colors[y*W + x] = paletteIndex(p[i*3+2]);
+    }
+    settled = false;
+
+    // Same as Simulation::loadParticles(), the display may present them before the first tick
+    updateCells();
+}
+
+template<uint32_t W, uint32_t H>
+uint8_t Sand<W, H>::paletteIndex(uint32_t color) {
+    // Only called while loading, so a linear search is fine
+    for (int i = 0; i < palettesize; ++i) {
+        if (palette[i] == color) {
+            return i;
+        }
+    }
+
+    if (palettesize >= SAND_MAX_COLORCOUNT) {
+        panic("Too many particle colors!\n");
+    }
+    palette[palettesize] = color;
+    return palettesize++;
+}
+
+template<uint32_t W, uint32_t H>
+inline bool Sand<W, H>::getPixel(uint32_t x, uint32_t y) const {
+    return grains[y*w32 + x/32]&(0x80000000 >> (x%32));
+}
+
+template<uint32_t W, uint32_t H>
+void Sand<W, H>::clearAll() {
+    memset(grains, 0, sizeof(grains));
+    memset(obstacles, 0, sizeof(obstacles));
+    particlecount = 0;
+    settled = false;
+    cellsdirty = true;
+}
+
+template<uint32_t W, uint32_t H>
+const particle_cell_t* Sand<W, H>::publish() {
+    cellsshown = cellslatest;
+    return cells[cellslatest];
+}
+
+template<uint32_t W, uint32_t H>
+inline void Sand<W, H>::moveRow(uint32_t y, int32_t dx, int32_t dy, uint32_t* cand) {
+    // Move the candidate grains of row y by one cell in direction dx, dy, where possible
+    // Grains that moved are removed from the candidates
+    int32_t ty = (int32_t)y + dy;
+    if (ty < 0 || ty >= (int32_t)height) {
+        return;
+    }
+    uint32_t* src = &grains[y*w32];
+    uint32_t* dst = &grains[ty*w32];
+    const uint32_t* obst = &obstacles[ty*w32];
+
+    if (dy == 0) {
+        // Sideways within the row, a whole run of grains can follow a free cell
+        // A grain moves if the cell next to it is free or its grain moves as well,
+        // which is a carry chain. It is resolved with a parallel prefix (Kogge-Stone)
+        // over the row, carrying into the next word in the direction of the chain
+        uint32_t cin = 0;
+        for (int n = 0; n < w32; ++n) {
+            int i = dx > 0 ? w32-1-n : n;
+            uint32_t free = ~(src[i] | obst[i]);
+
+            uint32_t g, p = cand[i];
+            if (dx > 0) {
+                g = p & ((free << 1) | cin);
+                for (int k = 1; k < 32; k <<= 1) {
+                    g |= p & (g << k);
+                    p &= p << k;
+                }
+                cin = ((free | g) >> 31) & 1;
+            } else {
+                g = p & ((free >> 1) | (cin << 31));
+                for (int k = 1; k < 32; k <<= 1) {
+                    g |= p & (g >> k);
+                    p &= p >> k;
+                }
+                cin = (free | g) & 1;
+            }
+            if (g == 0) {
+                continue;
+            }
+
+            src[i] &= ~g;
+            cand[i] &= ~g;
+            movedcount += __builtin_popcount(g);
+
+            // Move colors front to back, so no grain overwrites the one in front
+            uint32_t m = g;
+            while (m != 0) {
+                uint32_t b = dx > 0 ? 31 - __builtin_ctz(m) : __builtin_clz(m);
+                uint32_t x = i*32 + b;
+                colors[y*W + x + dx] = colors[y*W + x];
+                m &= ~(0x80000000 >> b);
+            }
+
+            // Grains at their new positions, the front one may end up in the next word
+            uint32_t moved = dx > 0 ? g >> 1 : g << 1;
+            src[i] |= moved;
+            arrived[y*w32 + i] |= moved;
+            uint32_t carry = dx > 0 ? g << 31 : g >> 31;
+            if (carry != 0) {
+                int j = dx > 0 ? i+1 : i-1;
+                src[j] |= carry;
+                arrived[y*w32 + j] |= carry;
+            }
+        }
+        return;
+    }
+
+    // Into the next row, grains there have already moved if they could
+    for (int i = 0; i < w32; ++i) {
+        // Candidates shifted to where they would end up, grains shifted out of
+        // the row are lost, which is the same as hitting the wall
+        uint32_t shifted;
+        if (dx > 0) {
+            shifted = (cand[i] >> 1) | (i > 0 ? cand[i-1] << 31 : 0);
+        } else if (dx < 0) {
+            shifted = (cand[i] << 1) | (i < w32-1 ? cand[i+1] >> 31 : 0);
+        } else {
+            shifted = cand[i];
+        }
+
+        uint32_t moved = shifted & ~(dst[i] | obst[i]);
+        if (moved == 0) {
+            continue;
+        }
+
+        dst[i] |= moved;
+        arrived[ty*w32 + i] |= moved;
+        movedcount += __builtin_popcount(moved);
+
+        // Remove the same grains from their old position, which may be in the neighbouring word
+        uint32_t from = dx > 0 ? moved << 1 : dx < 0 ? moved >> 1 : moved;
+        src[i] &= ~from;
+        cand[i] &= ~from;
+        if (dx != 0) {
+            // Never out of the row, since nothing is shifted in from beyond it
+            uint32_t carry = dx > 0 ? moved >> 31 : moved << 31;
+            int j = dx > 0 ? i-1 : i+1;
+            if (carry != 0 && j >= 0 && j < w32) {
+                src[j] &= ~carry;
+                cand[j] &= ~carry;
+            }
+        }
+
+        while (moved != 0) {
+            uint32_t b = __builtin_clz(moved);
+            uint32_t x = i*32 + b;
+            colors[ty*W + x] = colors[y*W + x - dx];
+            moved &= ~(0x80000000 >> b);
+        }
+    }
+}
+
+template<uint32_t W, uint32_t H>
+void Sand<W, H>::updateCells() {
+    // List all grains for the display, in the buffer it does not own
+    uint8_t outidx = cellsshown == 0 ? 1 : 0;
+    particle_cell_t* out = cells[outidx];
+    uint32_t n = 0;
+    for (uint32_t y = 0; y < height; ++y) {
+        for (uint32_t i = 0; i < w32; ++i) {
+            uint32_t row = grains[y*w32 + i];
+            while (row != 0) {
+                uint32_t b = __builtin_clz(row);
+                uint32_t x = i*32 + b;
+                out[n++] = {(uint8_t)x, (uint8_t)y, colors[y*W + x]};
+                row &= ~(0x80000000 >> b);
+            }
+        }
+    }
+    cellslatest = outidx;
+    cellsdirty = false;
+}
+
+template<uint32_t W, uint32_t H>
+__not_in_flash("sand") void Sand<W, H>::iterate(int32_t ax, int32_t ay, int32_t az) {
+    // Scale down accelerometer inputs, same as Simulation
+    ax = ax*scale / 256;
+    ay = ay*scale / 256;
+
+    movedcount = 0;
+
+    // Reduce to one of eight directions, each axis counts if it is at least
+    // ~tan(22.5 deg) of the other one
+    int32_t gx = 0, gy = 0;
+    if (abs(ax)*12 > abs(ay)*5) {
+        gx = ax > 0 ? 1 : -1;
+    }
+    if (abs(ay)*12 > abs(ax)*5) {
+        gy = ay > 0 ? 1 : -1;
+    }
+
+    int8_t dir = -1;
+    for (int d = 0; d < 8; ++d) {
+        if (sand_dirs[d][0] == gx && sand_dirs[d][1] == gy) {
+            dir = d;
+        }
+    }
+
+    if (dir != -1 && !(settled && dir == lastdir)) {
+        memset(arrived, 0, sizeof(arrived));
+
+        // Diagonal alternatives, the order alternates to avoid drifting to one side
+        const int8_t* fwd = sand_dirs[dir];
+        const int8_t* alt1 = sand_dirs[(dir+1) % 8];
+        const int8_t* alt2 = sand_dirs[(dir+7) % 8];
+
+        // Rows in front first, so grains can follow each other within a tick
+        for (uint32_t r = 0; r < height; ++r) {
+            uint32_t y = fwd[1] > 0 ? height-1-r : r;
+
+            uint32_t cand[w32];
+            bool any = false;
+            for (int i = 0; i < w32; ++i) {
+                cand[i] = grains[y*w32 + i] & ~arrived[y*w32 + i];
+                any |= cand[i] != 0;
+            }
+            if (!any) {
+                continue;
+            }
+
+            moveRow(y, fwd[0], fwd[1], cand);
+            if ((tick + y) & 1) {
+                moveRow(y, alt1[0], alt1[1], cand);
+                moveRow(y, alt2[0], alt2[1], cand);
+            } else {
+                moveRow(y, alt2[0], alt2[1], cand);
+                moveRow(y, alt1[0], alt1[1], cand);
+            }
+        }
+
+        settled = movedcount == 0;
+        if (!settled) {
+            cellsdirty = true;
+        }
+    }
+    lastdir = dir;
+
+    if (cellsdirty) {
+        updateCells();
+    }
+
+    tick++;
+}
@@ -11,8 +11,8 @@ import png
 
 VERSION_STR = "0.2.0"
 
-DEFAULT_SIZE = 32
-MAX_PARTICLES = 512
+# Must match DISPLAY_WIDTH and DISPLAY_HEIGHT, see hub75_geometry.h
+DEFAULT_SIZE = (32, 32)
 
 HEADER_TEMPLATE = f"""#pragma once
 
@@ -54,12 +54,18 @@ def gamma8b(s: int) -> int:
     return int(255*gamma(s/255))
 
 
-def convert_png(filename: str, size: int, gamma_correct: bool) -> Tuple[str, List[Tuple[int, int, int]]]:
+def parse_size(s: str) -> Tuple[int, int]:
+    # Either WIDTHxHEIGHT or a single number for square displays
+    w, _, h = s.lower().partition("x")
+    return int(w), int(h or w)
+
+
+def convert_png(filename: str, size: Tuple[int, int], gamma_correct: bool) -> Tuple[str, List[Tuple[int, int, int]]]:
     r = png.Reader(filename=filename)
     w, h, row, info = r.asRGBA8()
 
-    if w != size or h != size:
-        print(f"Expected PNG of size {size}x{size}, but got {w}x{h} instead!")
+    if (w, h) != size:
+        print(f"Expected PNG of size {size[0]}x{size[1]}, but got {w}x{h} instead!")
         raise ValueError("Invalid size")
 
     dat = bytearray(DATA_LINE_PREFIX)
@@ -99,7 +105,7 @@ def convert_png(filename: str, size: int, gamma_correct: bool) -> Tuple[str, Lis
     return str(dat.decode()), particles
 
 
-def convert_file(ifile: str, ofile: str, size: int, gamma_correct: bool, name=None) -> None:
+def convert_file(ifile: str, ofile: str, size: Tuple[int, int], gamma_correct: bool, name=None) -> None:
     ifile = os.path.abspath(ifile)
     ofile = os.path.abspath(ofile)
 
@@ -109,8 +115,10 @@ def convert_file(ifile: str, ofile: str, size: int, gamma_correct: bool, name=No
 
     data, particles = convert_png(ifile, size, gamma_correct)
 
-    if len(particles) > MAX_PARTICLES:
-        raise ValueError(f"Got {particles} particles, but only {MAX_PARTICLES} are supported!"
+    # Sand stages can fill the whole screen, the particle engine checks its own limit when loading
+    max_particles = size[0]*size[1]
+    if len(particles) > max_particles:
+        raise ValueError(f"Got {particles} particles, but only {max_particles} are supported!"
                          f"\nPlease check your image transparency layer.")
 
     out = HEADER_TEMPLATE.format(
@@ -161,7 +169,7 @@ const uint8_t {{name}}[] = {{{{
 GOL_LINE_PREFIX = b"    "
 
 
-def convert_golfile(ifile: Path, ofile: Path, size: int, name=None) -> None:
+def convert_golfile(ifile: Path, ofile: Path, size: Tuple[int, int], name=None) -> None:
     if name is None:
         name = ifile.stem
         name = name.replace(".", "_").replace("-", "_").replace(" ", "_").upper()
@@ -170,8 +178,8 @@ def convert_golfile(ifile: Path, ofile: Path, size: int, name=None) -> None:
     r = png.Reader(filename=ifile)
     w, h, row, info = r.asRGBA8()
 
-    if w != size or h != size:
-        print(f"Expected PNG of size {size}x{size}, but got {w}x{h} instead!")
+    if (w, h) != size:
+        print(f"Expected PNG of size {size[0]}x{size[1]}, but got {w}x{h} instead!")
         raise ValueError("Invalid size")
 
     dat = bytearray(GOL_LINE_PREFIX)
@@ -245,7 +253,8 @@ if __name__ == "__main__":
         sys.exit(1)
 
     parser = argparse.ArgumentParser(description=f"Convert PNG files to headers\nVersion {VERSION_STR}")
-    parser.add_argument("--size", action="store", default=DEFAULT_SIZE)
+    parser.add_argument("--size", action="store", type=parse_size, default=DEFAULT_SIZE,
+                        help="Display size, WIDTHxHEIGHT or a single number for square displays")
     subparsers = parser.add_subparsers(required=True)
 
     parser_stages = subparsers.add_parser("stages", description="Compile stages")
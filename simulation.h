@@ -1,26 +1,137 @@
 #pragma once
 
 #include <stdio.h>
+#include <string.h>
 #include "math.h"
 #include "pico/stdlib.h"
+#include "hardware/interp.h"
 
+#include "worksplit.h"
+
+// Particle capacity of the simulation used by the firmware
+// Every second cell of a 32x32 world
 #define SIM_MAX_PARTICLECOUNT 512
 
+// Maximum number of distinct particle colors per stage
+// Particles only store an index into the palette
+#define SIM_MAX_COLORCOUNT 256
+
 #define SIM_Z_NOISE_FACTOR 8
 
+// Seed used for random jitter unless seed() is called
+#define SIM_DEFAULT_SEED 0x2545F491
+
+// Maximum average number of positions a particle may be shifted by during an
+// incremental sort before falling back to a full sort
+#define SIM_SORT_FIXUP_LIMIT 2
+
+// Number of consecutive ticks a particle has to stay in its cell before it may
+// be put to sleep. Two ticks are needed to detect the period-2 bounce against the floor
+#define SIM_REST_TICKS 2
+
+// Change of the scaled acceleration that wakes up all sleeping particles
+// With 0, the result is identical to simulating every particle. Larger values keep
+// particles asleep through sensor noise, but they then no longer react to small changes
+#define SIM_WAKE_THRESHOLD 0
+
+// Per-particle rest state, a count of ticks without cell change and flags
+#define SIM_REST_COUNT  0x3F
+#define SIM_REST_PHASE  0x40  // Tick parity when the particle went to sleep
+#define SIM_REST_ASLEEP 0x80
+
+// Highest supported speed in cells per tick, see Simulation::speed
+// Velocities must stay well within 16 bits
+#define SIM_MAX_SPEED 4
+
+// Number of particles per chunk when the velocity pass is split across cores
+// Small enough that a chunk fits into a stall window of the display driver
+#define SIM_SPLIT_CHUNK 16
+
+// Collect per-tick workload counters in Simulation::stats
+// Disabled by default, counting then compiles to nothing
+// Counts must not have side effects. They are still evaluated and discarded when
+// disabled, so that variables only used for counting are not unused
+#ifndef SIM_STATS
+#define SIM_STATS 0
+#endif
+
+#if SIM_STATS
+#define SIM_COUNT(counter, n) (stats.counter += (n))
+#else
+#define SIM_COUNT(counter, n) ((void)(n))
+#endif
+
+// Maintain a grid with the index of the particle in every cell, see Simulation::particleAt()
+// Costs two bytes per cell, disabled by default
+#ifndef SIM_INDEX_GRID
+#define SIM_INDEX_GRID 0
+#endif
+
+// Grid entry of cells without a particle, including obstacles
+#define SIM_NO_PARTICLE 0xFFFF
+
+#if SIM_INDEX_GRID
+#define SIM_GRID_SET(idx, i) (grid[idx] = (i))
+#else
+#define SIM_GRID_SET(idx, i) ((void)0)
+#endif
+
 // Bounce formula copied from Adafruit_PixelDust
 #define BOUNCE(n) n = ((-n) * elasticity / 256) ///< 1-axis elastic bounce
 
 
-typedef struct particle {
-    int32_t x, y;  // Position in particle space
+enum SIM_SORTMODE {
+    SIM_SORTMODE_NONE,          // Never sort, particles are processed in load order
+    SIM_SORTMODE_FULL,          // Fully sort particles every tick
+    SIM_SORTMODE_INCREMENTAL,   // Re-use order from previous tick if the direction is unchanged
+};
+
+// Particles are stored as separate arrays for position, velocity and color
+// This way, each pass over the particles only needs to touch the fields it uses
+
+typedef struct particle_pos {
+    uint16_t x, y;  // Position in particle space, 256 per cell
+} particle_pos_t;
+
+typedef struct particle_vel {
     int16_t vx, vy;  // Velocity in particle space
-    uint32_t color;  // RGB Color of the particle
-} particle_t;
+} particle_vel_t;
+
+// What the display needs to draw a particle, written by the simulation every tick
+typedef struct particle_cell {
+    uint8_t x, y;   // Cell coordinates
+    uint8_t color;  // Index into palette
+} particle_cell_t;
+
+// Work done during one call to Simulation::iterate(), only counted with SIM_STATS
+typedef struct sim_stats {
+    uint32_t moved;       // Particles that changed their cell
+    uint32_t walls;       // Bounces off the edges of the world, per axis
+    uint32_t collisions;  // Moves into an occupied cell along one axis
+    uint32_t diagonals;   // Diagonal moves into an occupied cell, see sim_diag_table
+    uint32_t clamps;      // Velocities limited to the maximum speed
+    uint32_t sortmoves;   // Particles moved to another index by sorting
+} sim_stats_t;
+
 
+/*
+ * Particle simulation on a grid of W x H cells
+ *
+ * Geometry and particle capacity are template parameters, so that all index
+ * calculations and bounds are compile-time constants. With power-of-two sizes,
+ * multiplications and divisions by the width become shifts and masks.
+ *
+ * The capacity defaults to every second cell being a particle, but can be set lower
+ * to save RAM, e.g. when only stages with few particles are used.
+ */
+template<uint32_t W, uint32_t H, uint32_t MaxParticles = W*H/2>
 class Simulation {
 public:
-    Simulation(uint32_t w, uint32_t h, uint8_t scale, uint32_t count=SIM_MAX_PARTICLECOUNT, uint8_t e=128, bool sort=false);
+    static constexpr uint32_t width = W;
+    static constexpr uint32_t height = H;
+    static constexpr uint32_t maxParticles = MaxParticles;
+
+    explicit Simulation(uint8_t scale, uint8_t e=128, SIM_SORTMODE sort=SIM_SORTMODE_NONE);
 
     void loadBackground(const uint32_t* bg);
     void loadParticles(const uint32_t* p, uint32_t count);
@@ -31,18 +142,1099 @@ public:
 
     void clearAll();
 
+    // Reset the random number generator used for jitter
+    // The same seed and inputs always lead to the same simulation results
+    void seed(uint32_t s);
+
     void iterate(int32_t ax, int32_t ay, int32_t az);
 
     uint32_t particlecount;
-    particle_t particles[SIM_MAX_PARTICLECOUNT];
+    particle_pos_t positions[MaxParticles];
+    particle_vel_t velocities[MaxParticles];
+    uint8_t colors[MaxParticles];  // Index into palette
+
+    uint32_t palette[SIM_MAX_COLORCOUNT];  // RGB Colors of the particles
+    uint32_t palettesize;
+
+    // Hand the cells of all particles after the last tick to the display
+    // The returned buffer is not written to until the next call, which
+    // implicitly hands it back. There are particlecount entries
+    const particle_cell_t* publish();
 
     bool rand;
 
     uint8_t scale, elasticity;
 
+    // Maximum speed in cells per tick, between 1 and SIM_MAX_SPEED
+    // Faster particles move across several cells per tick, see traceMove()
+    uint8_t speed;
+
+    SIM_SORTMODE sortmode;
+
+    // Time taken by sorting during the last call to iterate(), in us
+    uint32_t sorttime;
+
+    // Skip particles that have come to rest, see iterate()
+    // Only takes effect while rand is off, since random jitter never lets a particle settle
+    bool activeset;
+
+    // Number of particles skipped during the last call to iterate()
+    uint32_t sleepingcount;
+
+    // Counters of the last call to iterate(), all zero unless SIM_STATS is set
+    sim_stats_t stats;
+
+    // If set, the velocity pass is split into chunks of SIM_SPLIT_CHUNK particles that
+    // another core can help with. The results are the same as without it
+    worksplit_t* split;
+
+    // Bring resting particles to the exact state of the full simulation
+    // Only needed to compare sub-cell positions or velocities, cells always match
+    void wakeAll();
+
+    // State of particle i as the full simulation would have it, without waking it up
+    // Differs from positions and velocities for sleeping particles in the other phase
+    void exactState(uint32_t i, particle_pos_t& pos, particle_vel_t& vel) const;
+
+#if SIM_INDEX_GRID
+    // Index of the particle in cell x, y after the last tick, or SIM_NO_PARTICLE
+    // Allows neighbour queries and walking the particles in cell order.
+    // Not double-buffered, so only valid on the core calling iterate()
+    inline uint16_t particleAt(uint32_t x, uint32_t y) const {
+        return grid[y*width + x];
+    }
+#endif
+
 private:
-    bool sort;
-    uint32_t width, height, w32;
-    uint32_t xMax, yMax;
-    uint32_t bitmap[32];
-};
\ No newline at end of file
+    // Occupancy is stored as one bit per cell, with w32 words per row
+    static constexpr uint32_t w32 = (W+31)/32;
+    static constexpr uint32_t xMax = W*256-1, yMax = H*256-1;
+
+    // Number of buckets for sorting particles
+    // Must be at least width+height-1, which is enough for the diagonal directions
+    static constexpr uint32_t sortBuckets = W+H;
+
+    static_assert(W <= 256 && H <= 256, "Positions are stored as 16-bit integers");
+    static_assert(sortBuckets <= 256, "Sort keys are stored as 8-bit integers");
+    static_assert(MaxParticles < SIM_NO_PARTICLE, "Particle indices are stored as 16-bit integers");
+
+    // Cell indices are computed by interpolator 0 if the width is a power of two
+    static constexpr bool interpIndex = (W & (W-1)) == 0;
+    // The bitmap can be addressed by cell index if rows are whole words
+    static constexpr bool packedRows = W % 32 == 0;
+
+    uint8_t paletteIndex(uint32_t color);
+
+    inline void setupInterp();
+    inline uint32_t cellIndex(uint32_t x, uint32_t y);
+    inline void setCell(uint32_t idx);
+    inline void clearCell(uint32_t idx);
+    inline bool getCell(uint32_t idx) const;
+    static inline uint32_t gridIndex(particle_pos_t p);
+
+    inline int32_t firstOccupied(uint32_t y, int32_t from, int32_t to) const;
+    void traceMove(uint32_t i, int32_t& newx, int32_t& newy);
+
+    static inline uint32_t nextRandom(uint32_t& state);
+
+    inline bool accelerate(uint32_t i, uint32_t& rng);
+    static void accelerateChunk(void* ctx, uint32_t chunk);
+
+    inline void wakeParticle(uint32_t i);
+    inline void markFreed(uint32_t x, uint32_t y);
+    inline bool isFreedNear(uint32_t x, uint32_t y) const;
+    inline void updateRest(uint32_t i, particle_pos_t oldpos, bool moved);
+
+    inline void swapParticles(uint32_t i, uint32_t j);
+    void sortParticles(int q);
+    bool fixupParticles(int q);
+
+    static constexpr uint32_t chunkCount = (MaxParticles+SIM_SPLIT_CHUNK-1)/SIM_SPLIT_CHUNK;
+
+    int32_t tickax, tickay, tickaz2;  // Scaled inputs of the current tick
+    uint32_t chunkrng[chunkCount];  // Random number state at the start of each chunk
+#if SIM_STATS
+    uint32_t chunkclamps[chunkCount];  // Clamped velocities per chunk, summed after the pass
+#endif
+
+    int8_t lastq;  // Direction of the last sort, -1 if unsorted
+    bool cellschanged;  // Any particle changed its cell since the last sort
+    uint32_t rngstate;
+    uint32_t bitmap[H*w32];
+#if SIM_INDEX_GRID
+    uint16_t grid[H*W];  // Particle in each cell, by cell index
+#endif
+    uint8_t sortkeys[MaxParticles];
+
+    // Resting particles, see iterate()
+    // restpos and restvel hold the state from two ticks ago for awake particles,
+    // and the other half of the bounce cycle for sleeping ones
+    uint32_t tick;  // Number of completed ticks
+    bool resting;  // Rest tracking active during the current tick
+    int32_t restax, restay;
+    uint8_t reste;
+    particle_pos_t restpos[MaxParticles];
+    particle_vel_t restvel[MaxParticles];
+    uint8_t reststate[MaxParticles];  // SIM_REST_* flags and count of ticks without cell change
+    particle_vel_t prevvel[MaxParticles];  // Velocity before the current tick, not sorted
+    uint32_t freedmap[2][H*w32];  // Neighbours of cells freed this and the previous tick
+
+    // Double-buffered output for the display, see publish()
+    particle_cell_t cells[2][MaxParticles];
+    uint8_t cellslatest;  // Buffer written by the last tick
+    int8_t cellsshown;    // Buffer owned by the display, -1 if none
+};
+
+template<uint32_t W, uint32_t H, uint32_t N>
+Simulation<W, H, N>::Simulation(uint8_t scale, uint8_t e, SIM_SORTMODE sort)
+    : particlecount(0), positions{}, velocities{}, colors{}, palette{}, palettesize(0),
+    rand(true), scale(scale), elasticity(e), speed(1), sortmode(sort), sorttime(0),
+    activeset(true), sleepingcount(0), stats{}, split(nullptr),
+    tickax(0), tickay(0), tickaz2(0), chunkrng{},
+    lastq(-1), cellschanged(false), rngstate(SIM_DEFAULT_SEED), bitmap{0},
+    tick(0), resting(false), restax(0), restay(0), reste(0),
+    restpos{}, restvel{}, reststate{}, prevvel{}, freedmap{},
+    cells{}, cellslatest(0), cellsshown(-1)
+    {
+#if SIM_INDEX_GRID
+    memset(grid, 0xFF, sizeof(grid));
+#endif
+}
+
+template<uint32_t W, uint32_t H, uint32_t N>
+void Simulation<W, H, N>::seed(uint32_t s) {
+    // xorshift gets stuck at zero
+    rngstate = s != 0 ? s : SIM_DEFAULT_SEED;
+}
+
+template<uint32_t W, uint32_t H, uint32_t N>
+inline uint32_t Simulation<W, H, N>::nextRandom(uint32_t& state) {
+    // xorshift32, see Marsaglia, "Xorshift RNGs"
+    uint32_t x = state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    state = x;
+    return x;
+}
+
+// xorshift32 is linear over GF(2), so advancing the state by a fixed number of steps
+// is a matrix multiplication. The table holds the result for every nibble value at every
+// nibble position, the advanced state is the XOR of the entries for all eight nibbles.
+// Used to give every chunk of the velocity pass the same random numbers it would get
+// when processing all particles in order.
+typedef struct sim_rng_jump {
+    uint32_t t[8][16];
+} sim_rng_jump_t;
+
+static constexpr sim_rng_jump_t sim_make_rng_jump(uint32_t steps) {
+    sim_rng_jump_t jump{};
+    for (int bit = 0; bit < 32; ++bit) {
+        uint32_t x = 1u << bit;
+        for (uint32_t i = 0; i < steps; ++i) {
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+        }
+        for (uint32_t v = 0; v < 16; ++v) {
+            if (v & (1u << (bit%4))) {
+                jump.t[bit/4][v] ^= x;
+            }
+        }
+    }
+    return jump;
+}
+
+static constexpr sim_rng_jump_t sim_chunk_rng_jump = sim_make_rng_jump(SIM_SPLIT_CHUNK);
+
+static inline uint32_t sim_rng_advance_chunk(uint32_t x) {
+    uint32_t r = 0;
+    for (int n = 0; n < 8; ++n) {
+        r ^= sim_chunk_rng_jump.t[n][(x >> (4*n)) & 0xF];
+    }
+    return r;
+}
+
+// Resolution of diagonal moves into an occupied cell, indexed by SIM_DIAG_* bits
+// Each entry tells which axes keep their motion, the others are cancelled and bounce.
+// The particle tries to skid along the "wall" with the faster axis first
+#define SIM_DIAG_TARGET   0x1  // Target cell occupied
+#define SIM_DIAG_XNEIGH   0x2  // Neighbour in x direction occupied
+#define SIM_DIAG_YNEIGH   0x4  // Neighbour in y direction occupied
+#define SIM_DIAG_XFASTER  0x8  // |vx| >= |vy|
+
+#define SIM_KEEP_X 0x1
+#define SIM_KEEP_Y 0x2
+
+static constexpr uint8_t sim_diag_table[16] = {
+        // Y faster, free target, then neighbours x/y occupied: --, x-, -y, xy
+        SIM_KEEP_X | SIM_KEEP_Y, SIM_KEEP_Y,
+        SIM_KEEP_X | SIM_KEEP_Y, SIM_KEEP_Y,
+        SIM_KEEP_X | SIM_KEEP_Y, SIM_KEEP_X,
+        SIM_KEEP_X | SIM_KEEP_Y, 0,
+        // X faster, same order
+        SIM_KEEP_X | SIM_KEEP_Y, SIM_KEEP_X,
+        SIM_KEEP_X | SIM_KEEP_Y, SIM_KEEP_Y,
+        SIM_KEEP_X | SIM_KEEP_Y, SIM_KEEP_X,
+        SIM_KEEP_X | SIM_KEEP_Y, 0,
+};
+
+// Decisions of the branches the table replaces, only used to check it at compile time
+// The branches themselves are run against the table by the fuzz harness
+static constexpr uint8_t sim_diag_reference(bool target, bool xneigh, bool yneigh, bool xfaster) {
+    if (!target) {
+        return SIM_KEEP_X | SIM_KEEP_Y;
+    }
+    if (xfaster) {
+        if (!xneigh) {
+            return SIM_KEEP_X;
+        } else if (!yneigh) {
+            return SIM_KEEP_Y;
+        }
+    } else {
+        if (!yneigh) {
+            return SIM_KEEP_Y;
+        } else if (!xneigh) {
+            return SIM_KEEP_X;
+        }
+    }
+    return 0;
+}
+
+static constexpr bool sim_diag_table_valid() {
+    for (uint32_t i = 0; i < 16; ++i) {
+        if (sim_diag_table[i] != sim_diag_reference(i & SIM_DIAG_TARGET, i & SIM_DIAG_XNEIGH,
+                                                    i & SIM_DIAG_YNEIGH, i & SIM_DIAG_XFASTER)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(sim_diag_table_valid(), "Diagonal collision table does not match the reference");
+
+template<uint32_t W, uint32_t H, uint32_t N>
+void Simulation<W, H, N>::loadBackground(const uint32_t *bg) {
+    // Copy obstacles from image
+    for (int x = 0; x < width; ++x) {
+        for (int y = 0; y < height; ++y) {
+            // If non-black pixel, mark as obstacle
+            if (bg[y*width+x]!=0) {
+                setPixel(x, y);
+            }
+        }
+    }
+}
+
+template<uint32_t W, uint32_t H, uint32_t N>
+void Simulation<W, H, N>::loadParticles(const uint32_t *p, uint32_t count) {
+    if (count > N) {
+        panic("Too many particles!\n");
+    }
+    particlecount = count;
+    palettesize = 0;
+    lastq = -1;  // Order of particles no longer matches any direction
+    resting = false;
+    sleepingcount = 0;
+
+    // The display may present the stage before the first tick, so it needs cells
+    // already. Written to the buffer it does not own, it might still be drawing
+    uint8_t outidx = cellsshown == 0 ? 1 : 0;
+    particle_cell_t* out = cells[outidx];
+
+    for (int i = 0; i < particlecount; ++i) {
+        positions[i].x = 256*p[i*3]+128;
+        positions[i].y = 256*p[i*3+1]+128;
+        colors[i] = paletteIndex(p[i*3+2]);
+        velocities[i].vx = 0;
+        velocities[i].vy = 0;
+        reststate[i] = 0;
+        setPixel(positions[i].x/256, positions[i].y/256);
+        SIM_GRID_SET(gridIndex(positions[i]), i);
+        out[i] = {(uint8_t)p[i*3], (uint8_t)p[i*3+1], colors[i]};
+    }
+    cellslatest = outidx;
+}
+
+template<uint32_t W, uint32_t H, uint32_t N>
+uint8_t Simulation<W, H, N>::paletteIndex(uint32_t color) {
+    // Only called while loading, so a linear search is fine
+    for (int i = 0; i < palettesize; ++i) {
+        if (palette[i] == color) {
+            return i;
+        }
+    }
+
+    if (palettesize >= SIM_MAX_COLORCOUNT) {
+        panic("Too many particle colors!\n");
+    }
+    palette[palettesize] = color;
+    return palettesize++;
+}
+
+template<uint32_t W, uint32_t H, uint32_t N>
+const particle_cell_t* Simulation<W, H, N>::publish() {
+    // The previously published buffer is free again, the display acknowledged it
+    // before we are called. If the last tick did not write anything, the latest
+    // buffer may be published twice, which is fine since it is still up to date
+    cellsshown = cellslatest;
+    return cells[cellslatest];
+}
+
+// Each row of the bitmap consists of w32 words, the leftmost cell is the MSB of the first word
+
+template<uint32_t W, uint32_t H, uint32_t N>
+inline void Simulation<W, H, N>::setPixel(uint32_t x, uint32_t y) {
+    bitmap[y*w32 + x/32] |= 0x80000000 >> (x%32);
+}
+
+template<uint32_t W, uint32_t H, uint32_t N>
+inline void Simulation<W, H, N>::clearPixel(uint32_t x, uint32_t y) {
+    bitmap[y*w32 + x/32] &= ~(0x80000000 >> (x%32));
+}
+
+template<uint32_t W, uint32_t H, uint32_t N>
+inline bool Simulation<W, H, N>::getPixel(uint32_t x, uint32_t y) const {
+    return bitmap[y*w32 + x/32]&(0x80000000 >> (x%32));
+}
+
+template<uint32_t W, uint32_t H, uint32_t N>
+inline void Simulation<W, H, N>::setupInterp() {
+    // Lane 0 takes the subcell x position and lane 1 the y position, the full result
+    // is the cell index (y/256)*W + x/256
+    // Must be called on the core that uses cellIndex(), each core has its own interpolators
+    if constexpr (interpIndex) {
+        constexpr uint32_t wbits = __builtin_ctz(W);
+        constexpr uint32_t hbits = 32 - __builtin_clz(H-1);
+
+        interp_config c = interp_default_config();
+        interp_config_set_shift(&c, 8);
+        interp_config_set_mask(&c, 0, wbits > 0 ? wbits-1 : 0);
+        interp_set_config(interp0, 0, &c);
+
+        c = interp_default_config();
+        interp_config_set_shift(&c, 8-wbits);
+        interp_config_set_mask(&c, wbits, hbits > 0 ? wbits+hbits-1 : wbits);
+        interp_set_config(interp0, 1, &c);
+
+        interp_set_base(interp0, 2, 0);
+    }
+}
+
+template<uint32_t W, uint32_t H, uint32_t N>
+inline uint32_t Simulation<W, H, N>::cellIndex(uint32_t x, uint32_t y) {
+    if constexpr (interpIndex) {
+        interp_set_accumulator(interp0, 0, x);
+        interp_set_accumulator(interp0, 1, y);
+        return interp_peek_full_result(interp0);
+    } else {
+        return (y/256)*width + x/256;
+    }
+}
+
+template<uint32_t W, uint32_t H, uint32_t N>
+inline void Simulation<W, H, N>::setCell(uint32_t idx) {
+    if constexpr (packedRows) {
+        bitmap[idx/32] |= 0x80000000 >> (idx%32);
+    } else {
+        setPixel(idx%width, idx/width);
+    }
+}
+
+template<uint32_t W, uint32_t H, uint32_t N>
+inline void Simulation<W, H, N>::clearCell(uint32_t idx) {
+    if constexpr (packedRows) {
+        bitmap[idx/32] &= ~(0x80000000 >> (idx%32));
+    } else {
+        clearPixel(idx%width, idx/width);
+    }
+}
+
+template<uint32_t W, uint32_t H, uint32_t N>
+inline uint32_t Simulation<W, H, N>::gridIndex(particle_pos_t p) {
+    // Same as cellIndex(), but usable before setupInterp()
+    return (p.y/256)*width + p.x/256;
+}
+
+template<uint32_t W, uint32_t H, uint32_t N>
+inline bool Simulation<W, H, N>::getCell(uint32_t idx) const {
+    if constexpr (packedRows) {
+        return bitmap[idx/32]&(0x80000000 >> (idx%32));
+    } else {
+        return getPixel(idx%width, idx/width);
+    }
+}
+
+template<uint32_t W, uint32_t H, uint32_t N>
+inline int32_t Simulation<W, H, N>::firstOccupied(uint32_t y, int32_t from, int32_t to) const {
+    // First occupied cell of row y from cell from to cell to, both included, or -1
+    // Scans whole words, the leftmost cell is the MSB, so going right is a count of
+    // leading zeros and going left a count of trailing zeros
+    const uint32_t* row = &bitmap[y*w32];
+    int32_t lo = from < to ? from : to;
+    int32_t hi = from < to ? to : from;
+    int32_t wlo = lo/32, whi = hi/32;
+    for (int32_t n = 0; n <= whi-wlo; ++n) {
+        int32_t wi = from <= to ? wlo+n : whi-n;
+        uint32_t bits = row[wi];
+        if (wi == wlo) {
+            bits &= 0xFFFFFFFF >> (lo%32);
+        }
+        if (wi == whi) {
+            bits &= 0xFFFFFFFF << (31 - hi%32);
+        }
+        if (bits != 0) {
+            return wi*32 + (from <= to ? __builtin_clz(bits) : 31 - __builtin_ctz(bits));
+        }
+    }
+    return -1;
+}
+
+template<uint32_t W, uint32_t H, uint32_t N>
+__not_in_flash("simulation") void Simulation<W, H, N>::traceMove(uint32_t i, int32_t& newx, int32_t& newy) {
+    // Move particle i towards newx, newy across several cells, stopping in front of
+    // the first occupied cell on the way
+    // The path is split into the runs of cells it covers in each row. Consecutive runs
+    // share the column where the path crosses into the next row, so the first occupied
+    // cell is always either straight ahead in the row or straight ahead vertically.
+    // The particle then stops at the edge of its last free cell and bounces off that axis
+    int32_t x0 = positions[i].x, y0 = positions[i].y;
+    int32_t dx = newx - x0, dy = newy - y0;
+    int32_t cy0 = y0/256, cy1 = newy/256;
+    int32_t sy = cy1 > cy0 ? 1 : -1;
+
+    int32_t entryx = x0;
+    for (int32_t r = cy0; ; r += sy) {
+        // Where the path leaves this row, at the boundary to the next one
+        int32_t exitx = newx;
+        if (r != cy1) {
+            int32_t by = sy > 0 ? (r+1)*256 : r*256;
+            exitx = x0 + (by - y0)*dx/dy;
+        }
+
+        int32_t ca = entryx/256, cb = exitx/256;
+        int32_t from = ca;
+        if (r == cy0) {
+            // Skip the cell of the particle itself
+            if (ca == cb) {
+                entryx = exitx;
+                continue;
+            }
+            from = ca + (cb > ca ? 1 : -1);
+        }
+
+        int32_t bx = firstOccupied(r, from, cb);
+        if (bx >= 0) {
+            if (bx == ca && r != cy0) {
+                // Blocked when entering the row, stop at the edge of the previous one
+                newx = entryx;
+                newy = sy > 0 ? r*256-1 : (r+1)*256;
+                BOUNCE(velocities[i].vy);
+            } else {
+                // Blocked within the row, stop at the edge of the cell in front of it
+                int32_t sx = cb > ca ? 1 : -1;
+                newx = sx > 0 ? bx*256-1 : (bx+1)*256;
+                int32_t ty = y0 + (newx - x0)*dy/dx;
+                newy = ty < r*256 ? r*256 : ty > r*256+255 ? r*256+255 : ty;
+                BOUNCE(velocities[i].vx);
+            }
+            SIM_COUNT(collisions, 1);
+            return;
+        }
+
+        if (r == cy1) {
+            return;
+        }
+        entryx = exitx;
+    }
+}
+
+static inline uint32_t sim_isqrt_ceil(uint32_t n) {
+    // Bitwise integer square root, rounded up
+    uint32_t root = 0;
+    uint32_t bit = 1u << 30;
+    while (bit > n) {
+        bit >>= 2;
+    }
+
+    while (bit != 0) {
+        if (n >= root + bit) {
+            n -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    // Anything left over means the real root is slightly larger
+    if (n > 0) {
+        root++;
+    }
+    return root;
+}
+
+static inline int8_t sim_octant(int32_t ax, int32_t ay) {
+    // Direction of the acceleration as one of 8 octants, counterclockwise from +x
+    // Same as rounding atan2(ay, ax) to the nearest multiple of 45 degrees, but
+    // integer only. An axis is within 22.5 degrees if the other component is below
+    // tan(22.5) = sqrt(2)-1 times its own, which is (x+y)^2 < 2x^2 without roots.
+    // The products are exact, so the result never differs from the exact angle
+    uint64_t x = ax < 0 ? -(int64_t)ax : ax;
+    uint64_t y = ay < 0 ? -(int64_t)ay : ay;
+    if (x == 0 && y == 0) {
+        return 0;
+    }
+
+    // 0 along the x axis, 1 diagonal, 2 along the y axis
+    int8_t s = 1;
+    if ((x+y)*(x+y) < 2*x*x) {
+        s = 0;
+    } else if ((x+y)*(x+y) < 2*y*y) {
+        s = 2;
+    }
+
+    if (ay >= 0) {
+        return ax >= 0 ? s : 4-s;
+    } else {
+        return ax >= 0 ? (8-s) % 8 : 4+s;
+    }
+}
+
+// Sort keys for each of the 8 directions, based on the comparison functions
+// from Adafruit_PixelDust. Rather than using true position along the
+// acceleration vector (which would be computationally expensive), an 8-way
+// approximation is 'good enough' and quick to compute.
+// Each direction is described by the coefficients for the x and y cell coordinates,
+// the key is then kx*x+ky*y, offset to start at zero.
+static const int8_t sim_sort_coeffs[8][2] = {
+        {-1,  0}, {-1, -1}, { 0, -1}, { 1, -1},
+        { 1,  0}, { 1,  1}, { 0,  1}, {-1,  1},
+};
+
+template<uint32_t W, uint32_t H, uint32_t N>
+inline void Simulation<W, H, N>::swapParticles(uint32_t i, uint32_t j) {
+    particle_pos_t tmppos = positions[i];
+    positions[i] = positions[j];
+    positions[j] = tmppos;
+
+    particle_vel_t tmpvel = velocities[i];
+    velocities[i] = velocities[j];
+    velocities[j] = tmpvel;
+
+    uint8_t tmpcolor = colors[i];
+    colors[i] = colors[j];
+    colors[j] = tmpcolor;
+
+    tmppos = restpos[i];
+    restpos[i] = restpos[j];
+    restpos[j] = tmppos;
+
+    tmpvel = restvel[i];
+    restvel[i] = restvel[j];
+    restvel[j] = tmpvel;
+
+    uint8_t tmpstate = reststate[i];
+    reststate[i] = reststate[j];
+    reststate[j] = tmpstate;
+
+    SIM_GRID_SET(gridIndex(positions[i]), i);
+    SIM_GRID_SET(gridIndex(positions[j]), j);
+}
+
+template<uint32_t W, uint32_t H, uint32_t N>
+__not_in_flash("simulation") void Simulation<W, H, N>::sortParticles(int q) {
+    // In-place bucket sort (also known as American flag sort) by projected cell index
+    // Runs in O(n + sortBuckets) without needing a second particle buffer.
+    // Order within a bucket is not preserved, but qsort() never guaranteed that either
+    int32_t kx = sim_sort_coeffs[q][0];
+    int32_t ky = sim_sort_coeffs[q][1];
+    int32_t k0 = (kx < 0 ? width-1 : 0) + (ky < 0 ? height-1 : 0);
+
+    uint16_t next[sortBuckets];
+    uint16_t end[sortBuckets];
+    memset(end, 0, sizeof(end));
+
+    // Calculate keys and count bucket sizes
+    for (int i = 0; i < particlecount; ++i) {
+        uint8_t key = kx*(positions[i].x/256) + ky*(positions[i].y/256) + k0;
+        sortkeys[i] = key;
+        end[key]++;
+    }
+
+    // Convert sizes to bucket boundaries
+    uint16_t start = 0;
+    for (int b = 0; b < sortBuckets; ++b) {
+        next[b] = start;
+        start += end[b];
+        end[b] = start;
+    }
+
+    // Swap every particle directly into its bucket
+    // Each swap places at least one particle at its final position
+    for (int b = 0; b < sortBuckets; ++b) {
+        while (next[b] < end[b]) {
+            int i = next[b];
+            uint8_t key = sortkeys[i];
+            if (key == b) {
+                // Already in the right bucket
+                next[b]++;
+                continue;
+            }
+
+            int j = next[key]++;
+            swapParticles(i, j);
+            SIM_COUNT(sortmoves, 2);
+            sortkeys[i] = sortkeys[j];
+            sortkeys[j] = key;
+        }
+    }
+}
+
+template<uint32_t W, uint32_t H, uint32_t N>
+__not_in_flash("simulation") bool Simulation<W, H, N>::fixupParticles(int q) {
+    // Insertion sort starting from the order of the previous tick
+    // Particles move at most one cell per tick, so as long as the direction is
+    // unchanged, almost all particles are already in the right place and this
+    // is barely more than a linear scan.
+    // Gives up once too many particles had to be moved, the caller then has to do
+    // a full sort. The particles are still all there, just not fully sorted.
+    int32_t kx = sim_sort_coeffs[q][0];
+    int32_t ky = sim_sort_coeffs[q][1];
+    int32_t k0 = (kx < 0 ? width-1 : 0) + (ky < 0 ? height-1 : 0);
+
+    uint32_t shifts = 0;
+    uint32_t limit = particlecount*SIM_SORT_FIXUP_LIMIT;
+
+    for (int i = 0; i < particlecount; ++i) {
+        uint8_t key = kx*(positions[i].x/256) + ky*(positions[i].y/256) + k0;
+
+        int j = i;
+        if (j > 0 && sortkeys[j-1] > key) {
+            // Out of order, shift larger keys up until there is room for this particle
+            particle_pos_t tmppos = positions[i];
+            particle_vel_t tmpvel = velocities[i];
+            uint8_t tmpcolor = colors[i];
+            particle_pos_t tmprestpos = restpos[i];
+            particle_vel_t tmprestvel = restvel[i];
+            uint8_t tmpstate = reststate[i];
+            do {
+                positions[j] = positions[j-1];
+                velocities[j] = velocities[j-1];
+                colors[j] = colors[j-1];
+                restpos[j] = restpos[j-1];
+                restvel[j] = restvel[j-1];
+                reststate[j] = reststate[j-1];
+                sortkeys[j] = sortkeys[j-1];
+                j--;
+            } while (j > 0 && sortkeys[j-1] > key);
+            positions[j] = tmppos;
+            velocities[j] = tmpvel;
+            colors[j] = tmpcolor;
+            restpos[j] = tmprestpos;
+            restvel[j] = tmprestvel;
+            reststate[j] = tmpstate;
+#if SIM_INDEX_GRID
+            for (int k = j; k <= i; ++k) {
+                grid[gridIndex(positions[k])] = k;
+            }
+#endif
+
+            shifts += i-j;
+            SIM_COUNT(sortmoves, i-j+1);
+            if (shifts > limit) {
+                return false;
+            }
+        }
+        sortkeys[j] = key;
+    }
+
+    return true;
+}
+
+/*
+ * Resting particles
+ *
+ * Without random jitter, a settled particle ends up bouncing in place, e.g. against
+ * the floor with its velocity alternating between two values. Its state then repeats
+ * every one or two ticks, and every cell it tried to move into was occupied. As long
+ * as those cells stay occupied and the acceleration does not change, it keeps doing
+ * exactly that, so it can be skipped entirely.
+ *
+ * A particle is put to sleep once it stayed in its cell for SIM_REST_TICKS ticks and its
+ * state matches the one from two ticks ago. The state from the previous tick is kept,
+ * so that the particle can be woken up in the right phase of its cycle.
+ *
+ * Whenever a particle leaves a cell, the neighbours of that cell are marked in freedmap.
+ * Sleeping particles check the map at their turn in the movement pass, which wakes them
+ * up in the same tick the full simulation would first see the free cell. Marks are kept
+ * for two ticks to also cover cells freed after a particle's turn.
+ * A change of the acceleration or elasticity wakes up all particles.
+ */
+
+template<uint32_t W, uint32_t H, uint32_t N>
+inline bool Simulation<W, H, N>::accelerate(uint32_t i, uint32_t& rng) {
+    // Returns whether the velocity had to be limited
+    // Apply acceleration
+    if (rand) {
+        // One random number is enough for both axes
+        // Multiply-shift instead of modulo to bring each half into range
+        uint32_t r = nextRandom(rng);
+        velocities[i].vx += tickax + (int32_t)(((r & 0xFFFF) * tickaz2) >> 16);
+        velocities[i].vy += tickay + (int32_t)(((r >> 16) * tickaz2) >> 16);
+    } else {
+        velocities[i].vx += tickax;
+        velocities[i].vy += tickay;
+    }
+
+    // Limit total velocity to one cell per tick by default, to prevent particles
+    // from clipping through each other. Faster particles trace their path instead
+    uint32_t limit = speed*256;
+    uint32_t v2 = (int32_t)velocities[i].vx*velocities[i].vx+(int32_t)velocities[i].vy*velocities[i].vy;
+    if (v2 > limit*limit) {
+        // Re-scale velocity while maintaining direction
+        // Integer only, since the RP2040 has no FPU but does have a hardware divider.
+        // Rounding the square root up keeps the result at or below 256 and within
+        // one step of the float version
+        int32_t k = (limit << 16) / sim_isqrt_ceil(v2);  // Pre-calculate scaling factor for performance
+        velocities[i].vx = velocities[i].vx*k / 65536;
+        velocities[i].vy = velocities[i].vy*k / 65536;
+        return true;
+    }
+    return false;
+}
+
+template<uint32_t W, uint32_t H, uint32_t N>
+__not_in_flash("simulation") void Simulation<W, H, N>::accelerateChunk(void* ctx, uint32_t chunk) {
+    // Velocity pass for one chunk of particles, may run on either core
+    Simulation* sim = (Simulation*)ctx;
+    uint32_t start = chunk*SIM_SPLIT_CHUNK;
+    uint32_t end = start+SIM_SPLIT_CHUNK < sim->particlecount ? start+SIM_SPLIT_CHUNK : sim->particlecount;
+
+    uint32_t rng = sim->chunkrng[chunk];
+    uint32_t clamps = 0;
+    for (uint32_t i = start; i < end; ++i) {
+        if (sim->reststate[i] & SIM_REST_ASLEEP) {
+            continue;
+        }
+        sim->prevvel[i] = sim->velocities[i];
+        clamps += sim->accelerate(i, rng);
+    }
+    sim->chunkrng[chunk] = rng;
+#if SIM_STATS
+    // Not added to stats directly, the other core might be working on another chunk
+    sim->chunkclamps[chunk] = clamps;
+#endif
+}
+
+template<uint32_t W, uint32_t H, uint32_t N>
+inline void Simulation<W, H, N>::wakeParticle(uint32_t i) {
+    // The stored state is from the tick the particle went to sleep. If an odd number
+    // of ticks completed since then, the full simulation would be in the other phase
+    if ((reststate[i] & SIM_REST_PHASE ? 1 : 0) == (tick & 1)) {
+        particle_pos_t tmppos = positions[i];
+        positions[i] = restpos[i];
+        restpos[i] = tmppos;
+
+        particle_vel_t tmpvel = velocities[i];
+        velocities[i] = restvel[i];
+        restvel[i] = tmpvel;
+    }
+    reststate[i] = 0;
+    sleepingcount--;
+}
+
+template<uint32_t W, uint32_t H, uint32_t N>
+void Simulation<W, H, N>::wakeAll() {
+    for (int i = 0; i < particlecount; ++i) {
+        if (reststate[i] & SIM_REST_ASLEEP) {
+            wakeParticle(i);
+        }
+        reststate[i] = 0;
+    }
+}
+
+template<uint32_t W, uint32_t H, uint32_t N>
+void Simulation<W, H, N>::exactState(uint32_t i, particle_pos_t& pos, particle_vel_t& vel) const {
+    // Same phase check as wakeParticle()
+    bool swapped = (reststate[i] & SIM_REST_ASLEEP) && (reststate[i] & SIM_REST_PHASE ? 1 : 0) == (tick & 1);
+    pos = swapped ? restpos[i] : positions[i];
+    vel = swapped ? restvel[i] : velocities[i];
+}
+
+template<uint32_t W, uint32_t H, uint32_t N>
+inline void Simulation<W, H, N>::markFreed(uint32_t x, uint32_t y) {
+    uint32_t* map = freedmap[tick & 1];
+    uint32_t y0 = y > 0 ? y-1 : 0;
+    uint32_t y1 = y < height-1 ? y+1 : height-1;
+    uint32_t x0 = x > 0 ? x-1 : 0;
+    uint32_t x1 = x < width-1 ? x+1 : width-1;
+    for (uint32_t ny = y0; ny <= y1; ++ny) {
+        for (uint32_t nx = x0; nx <= x1; ++nx) {
+            map[ny*w32 + nx/32] |= 0x80000000 >> (nx%32);
+        }
+    }
+}
+
+template<uint32_t W, uint32_t H, uint32_t N>
+inline bool Simulation<W, H, N>::isFreedNear(uint32_t x, uint32_t y) const {
+    uint32_t idx = y*w32 + x/32;
+    return (freedmap[0][idx] | freedmap[1][idx]) & (0x80000000 >> (x%32));
+}
+
+template<uint32_t W, uint32_t H, uint32_t N>
+inline void Simulation<W, H, N>::updateRest(uint32_t i, particle_pos_t oldpos, bool moved) {
+    uint8_t state = reststate[i];
+    if (moved) {
+        state = 0;
+    } else if ((state & SIM_REST_COUNT) < SIM_REST_COUNT) {
+        state++;
+    }
+
+    // Same state as two ticks ago?
+    bool repeated = positions[i].x == restpos[i].x && positions[i].y == restpos[i].y &&
+            velocities[i].vx == restvel[i].vx && velocities[i].vy == restvel[i].vy;
+
+    restpos[i] = oldpos;
+    restvel[i] = prevvel[i];
+
+    if (repeated && state >= SIM_REST_TICKS) {
+        state = SIM_REST_ASLEEP | ((tick & 1) ? SIM_REST_PHASE : 0);
+        sleepingcount++;
+    }
+    reststate[i] = state;
+}
+
+template<uint32_t W, uint32_t H, uint32_t N>
+__not_in_flash("simulation") void Simulation<W, H, N>::iterate(int32_t ax, int32_t ay, int32_t az) {
+    // Scale down accelerometer inputs
+    // The inputs should be normalised already
+    ax = ax*scale / 256;
+    ay = ay*scale / 256;
+
+#if SIM_STATS
+    memset(&stats, 0, sizeof(stats));
+#endif
+
+    int az2 = 0;
+    if (rand) {
+        az = abs(az*scale / (256*SIM_Z_NOISE_FACTOR));  // Used for random motion to topple stacks
+
+        az = (az >= (SIM_Z_NOISE_FACTOR / 2)) ? 1 : (SIM_Z_NOISE_FACTOR / 2 + 1) - az;  // Limit and invert
+        // Subtract z motion factor, will be added back later with randomness
+        ax -= az;
+        ay -= az;
+        az2 = az * 2 + 1;
+    }
+
+    // Resting particles can only be skipped if they would do exactly the same as before
+    bool track = activeset && !rand;
+    if (!track || !resting || abs(ax - restax) > SIM_WAKE_THRESHOLD || abs(ay - restay) > SIM_WAKE_THRESHOLD ||
+            elasticity != reste) {
+        if (resting) {
+            wakeAll();
+        }
+        resting = track;
+        restax = ax;
+        restay = ay;
+        reste = elasticity;
+    }
+    if (resting) {
+        // Marks from two ticks ago have been seen by every particle
+        memset(freedmap[tick & 1], 0, sizeof(freedmap[0]));
+    }
+
+    if (sortmode != SIM_SORTMODE_NONE) {
+        // Sorting from Adafruit_PixelDust
+        // The octant used to come from atan2(), which is slow soft-float on the M0+
+        int8_t q = sim_octant(ax, ay);
+        // Sort particles by position, bottom-to-top
+        absolute_time_t ts = get_absolute_time();
+        // If no particle changed its cell, the order from the last tick is still valid
+        if (sortmode != SIM_SORTMODE_INCREMENTAL || q != lastq || (cellschanged && !fixupParticles(q))) {
+            sortParticles(q);
+        }
+        lastq = q;
+        cellschanged = false;
+        sorttime = absolute_time_diff_us(ts, get_absolute_time());
+    } else {
+        sorttime = 0;
+    }
+
+    if (resting && sleepingcount == particlecount) {
+        // Everything is at rest, and nothing moved during the last tick that could
+        // wake a particle up. Nothing changes until the acceleration does
+        tick++;
+        return;
+    }
+
+    tickax = ax;
+    tickay = ay;
+    tickaz2 = az2;
+
+    // Every particle draws one random number, so each chunk starts SIM_SPLIT_CHUNK
+    // steps further into the sequence. Sleeping particles only exist without jitter
+    uint32_t chunks = (particlecount+SIM_SPLIT_CHUNK-1)/SIM_SPLIT_CHUNK;
+    if (rand) {
+        uint32_t rng = rngstate;
+        for (int c = 0; c < chunks; ++c) {
+            chunkrng[c] = rng;
+            rng = sim_rng_advance_chunk(rng);
+        }
+    }
+
+    if (split != nullptr) {
+        worksplit_run(split, accelerateChunk, this, chunks);
+    } else {
+        for (int c = 0; c < chunks; ++c) {
+            accelerateChunk(this, c);
+        }
+    }
+
+    if (rand && chunks > 0) {
+        // The last chunk ends where processing all particles in order would have
+        rngstate = chunkrng[chunks-1];
+    }
+
+#if SIM_STATS
+    for (int c = 0; c < chunks; ++c) {
+        stats.clamps += chunkclamps[c];
+    }
+#endif
+
+    // Update positions of grains while checking for collisions
+
+    int32_t newx, newy;
+    int32_t oldidx, newidx, delta;
+
+    // Write cells for the display into the buffer it does not own
+    // Every particle has to be written, sorting may have changed their order
+    uint8_t outidx = cellsshown == 0 ? 1 : 0;
+    particle_cell_t* out = cells[outidx];
+
+    setupInterp();
+
+    for (int i = 0; i < particlecount; ++i) {
+        if (reststate[i] & SIM_REST_ASLEEP) {
+            if (!isFreedNear(positions[i].x/256, positions[i].y/256)) {
+                out[i] = {(uint8_t)(positions[i].x/256), (uint8_t)(positions[i].y/256), colors[i]};
+                continue;
+            }
+            // A neighbouring cell might be free now, catch up on this tick
+            // Never happens with jitter, so the random number state is not touched
+            wakeParticle(i);
+            prevvel[i] = velocities[i];
+            bool clamped = accelerate(i, rngstate);
+            SIM_COUNT(clamps, clamped);
+        }
+
+        particle_pos_t oldpos = positions[i];
+
+        // Apply velocity to get new proposed position
+        newx = positions[i].x + velocities[i].vx;
+        newy = positions[i].y + velocities[i].vy;
+
+        // First, check that we are still inside the simulation area
+        if (newx < 0) {
+            newx = 0;
+            BOUNCE(velocities[i].vx);
+            SIM_COUNT(walls, 1);
+        } else if (newx > xMax) {
+            newx = xMax;
+            BOUNCE(velocities[i].vx);
+            SIM_COUNT(walls, 1);
+        }
+
+        if (newy < 0) {
+            newy = 0;
+            BOUNCE(velocities[i].vy);
+            SIM_COUNT(walls, 1);
+        } else if (newy > yMax) {
+            newy = yMax;
+            BOUNCE(velocities[i].vy);
+            SIM_COUNT(walls, 1);
+        }
+
+        // More than one cell away, can only happen with a raised speed limit
+        if (speed > 1 && (abs(newx/256 - positions[i].x/256) > 1 || abs(newy/256 - positions[i].y/256) > 1)) {
+            traceMove(i, newx, newy);
+        }
+
+        // Calculate "hash" of position in LED space
+        // Allows us to only need one comparison instead of several more computations
+        oldidx = cellIndex(positions[i].x, positions[i].y);
+        newidx = cellIndex(newx, newy);
+
+        if ((oldidx != newidx) && getCell(newidx)) {
+            // Tried to move to new pixel but it is already occupied
+            delta = abs(newidx-oldidx);
+            if (delta == 1) {
+                // Collision left or right, cancel x motion and bounce x
+                newx = positions[i].x;
+                BOUNCE(velocities[i].vx);
+                SIM_COUNT(collisions, 1);
+            } else if (delta == width) {
+                // Collision up or down, cancel y motion and bounce y
+                newy = positions[i].y;
+                BOUNCE(velocities[i].vy);
+                SIM_COUNT(collisions, 1);
+            } else {
+                // Diagonal collision, common in narrow passages
+                // Outcome only depends on the neighbouring cells and the faster axis
+                uint32_t k = SIM_DIAG_TARGET;
+                k |= getCell(cellIndex(newx, positions[i].y)) ? SIM_DIAG_XNEIGH : 0;
+                k |= getCell(cellIndex(positions[i].x, newy)) ? SIM_DIAG_YNEIGH : 0;
+                k |= abs(velocities[i].vx) >= abs(velocities[i].vy) ? SIM_DIAG_XFASTER : 0;
+
+                uint8_t keep = sim_diag_table[k];
+                SIM_COUNT(diagonals, 1);
+                if (!(keep & SIM_KEEP_X)) {
+                    newx = positions[i].x;
+                    BOUNCE(velocities[i].vx);
+                }
+                if (!(keep & SIM_KEEP_Y)) {
+                    newy = positions[i].y;
+                    BOUNCE(velocities[i].vy);
+                }
+            }
+
+            // Position changed, possibly back into the old cell
+            newidx = cellIndex(newx, newy);
+        }
+
+        // Finally, update bitmap and stored position
+        clearCell(oldidx);
+        positions[i].x = newx;
+        positions[i].y = newy;
+        setCell(newidx);
+        SIM_GRID_SET(oldidx, SIM_NO_PARTICLE);
+        SIM_GRID_SET(newidx, i);
+
+        out[i] = {(uint8_t)(newx/256), (uint8_t)(newy/256), colors[i]};
+
+        bool moved = oldidx != newidx;
+        cellschanged |= moved;
+        SIM_COUNT(moved, moved);
+        if (resting) {
+            if (moved) {
+                markFreed(oldpos.x/256, oldpos.y/256);
+            }
+            updateRest(i, oldpos, moved);
+        }
+    }
+    cellslatest = outidx;
+
+    tick++;
+}
+
+template<uint32_t W, uint32_t H, uint32_t N>
+void Simulation<W, H, N>::clearAll() {
+    // Clear entire bitmap
+    for (uint32_t & i : bitmap) {
+        i = 0;
+    }
+    memset(freedmap, 0, sizeof(freedmap));
+#if SIM_INDEX_GRID
+    memset(grid, 0xFF, sizeof(grid));
+#endif
+}
\ No newline at end of file
@@ -40,8 +40,8 @@ void Snake::init() {
     this->game_over = false;
 
     // Initialize snake
-    this->head_x = DISPLAY_SIZE/2;
-    this->head_y = DISPLAY_SIZE/2;
+    this->head_x = DISPLAY_WIDTH/2;
+    this->head_y = DISPLAY_HEIGHT/2;
     this->prev_dx = 0;
     this->prev_dy = 0;
     this->grid[head_x][head_y].flags = SNAKE_FLAG_BODY | SNAKE_FLAG_TAIL;
@@ -119,8 +119,8 @@ void Snake::update(float ax, float ay, float az) {
 
     // Prevent direction change if user wants to reverse onto itself
     if (!(grid[head_x][head_y].flags & SNAKE_FLAG_TAIL)) {
-        if ((head_x+dx+DISPLAY_SIZE)%DISPLAY_SIZE == grid[head_x][head_y].prev_x
-         && (head_y+dy+DISPLAY_SIZE)%DISPLAY_SIZE == grid[head_x][head_y].prev_y) {
+        if ((head_x+dx+DISPLAY_WIDTH)%DISPLAY_WIDTH == grid[head_x][head_y].prev_x
+         && (head_y+dy+DISPLAY_HEIGHT)%DISPLAY_HEIGHT == grid[head_x][head_y].prev_y) {
             // Continue in same direction as before
             dx = prev_dx;
             dy = prev_dy;
@@ -136,14 +136,14 @@ void Snake::update(float ax, float ay, float az) {
     // Check if we collide with a wall
     if (wall_collision) {
         // Game over on collision
-        if (new_x < 0 || new_y < 0 || new_x >= DISPLAY_SIZE || new_y >= DISPLAY_SIZE) {
+        if (new_x < 0 || new_y < 0 || new_x >= DISPLAY_WIDTH || new_y >= DISPLAY_HEIGHT) {
             game_over = true;
             return;
         }
     } else {
         // Wrap around
-        new_x = (new_x+DISPLAY_SIZE) % DISPLAY_SIZE;
-        new_y = (new_y+DISPLAY_SIZE) % DISPLAY_SIZE;
+        new_x = (new_x+DISPLAY_WIDTH) % DISPLAY_WIDTH;
+        new_y = (new_y+DISPLAY_HEIGHT) % DISPLAY_HEIGHT;
     }
 
     snake_node_t* next = &grid[new_x][new_y];
@@ -223,7 +223,7 @@ snake_node_t *Snake::advance_snake(snake_node_t *newhead) {
 void Snake::spawn_fruit(uint8_t color) {
     printf("Spawning new fruit...\n");
 
-    if (this->length >= DISPLAY_SIZE*DISPLAY_SIZE) {
+    if (this->length >= DISPLAY_WIDTH*DISPLAY_HEIGHT) {
         // No more room for fruits, don't spawn any
         // TODO: maybe add some kind of game won screen here
         return;
@@ -233,11 +233,11 @@ void Snake::spawn_fruit(uint8_t color) {
 
     // Find an empty spot by picking an index of remaining empty tiles
     // This way, we don't have to retry many times near the end of the game
-    int idx = rand()%(DISPLAY_SIZE*DISPLAY_SIZE-this->length);
+    int idx = rand()%(DISPLAY_WIDTH*DISPLAY_HEIGHT-this->length);
 
     int i = 0;
-    for (int x = 0; x < DISPLAY_SIZE; ++x) {
-        for (int y = 0; y < DISPLAY_SIZE; ++y) {
+    for (int x = 0; x < DISPLAY_WIDTH; ++x) {
+        for (int y = 0; y < DISPLAY_HEIGHT; ++y) {
             if (this->grid[x][y].flags == 0) {
                 // Empty spot, check if the index is right
                 if (i == idx) {
@@ -255,7 +255,7 @@ void Snake::spawn_fruit(uint8_t color) {
         }
     }
 
-    printf("Found fruit location: x=%u y=%u (idx=%u, max=%u)\n", pos_x, pos_y, idx, DISPLAY_SIZE*DISPLAY_SIZE-this->length);
+    printf("Found fruit location: x=%u y=%u (idx=%u, max=%u)\n", pos_x, pos_y, idx, DISPLAY_WIDTH*DISPLAY_HEIGHT-this->length);
 
     this->grid[pos_x][pos_y].flags |= SNAKE_FLAG_FRUIT;
     if (color == 0xFF) {
@@ -266,8 +266,8 @@ void Snake::spawn_fruit(uint8_t color) {
 }
 
 void Snake::draw() {
-    for (int x = 0; x < DISPLAY_SIZE; ++x) {
-        for (int y = 0; y < DISPLAY_SIZE; ++y) {
+    for (int x = 0; x < DISPLAY_WIDTH; ++x) {
+        for (int y = 0; y < DISPLAY_HEIGHT; ++y) {
             snake_node_t* node = &grid[x][y];
 
             // Draw node if flags are non-empty
@@ -58,5 +58,5 @@ private:
     bool wall_collision = true;
     bool game_over = false;
 
-    snake_node_t grid[DISPLAY_SIZE][DISPLAY_SIZE] = {0};
+    snake_node_t grid[DISPLAY_WIDTH][DISPLAY_HEIGHT] = {0};
 };
\ No newline at end of file
@@ -4,27 +4,62 @@
 // -------------------------------------------------------------------------- //
 // Stages that can be simulated
 #define STAGE(NAME) const stage_t STAGE_ ## NAME = {  \
+.engine=STAGE_ENGINE_PARTICLES,                       \
 STAGE_HEAD(NAME),                                     \
 .scale=MPU_SCALE,                                     \
 .elasticity=SIM_ELASTICITY,                           \
 .rand=true,                                           \
-};
+.speed=1,                                             \
+};                                                    \
+STAGE_CHECK_BG(NAME, NAME)
 
 #define STAGE_ADV(NAME, BGNAME, SCALE, ELASTICITY, RAND) const stage_t STAGE_ ## NAME = {  \
+.engine=STAGE_ENGINE_PARTICLES,                                                      \
 STAGE_HEAD(BGNAME),                                                                  \
 .scale=SCALE,                                                                      \
 .elasticity=ELASTICITY,                                                            \
 .rand=RAND,                                                                        \
-};
+.speed=1,                                                                          \
+};                                                                                 \
+STAGE_CHECK_BG(NAME, BGNAME)
+
+#define STAGE_SPEED(NAME, BGNAME, SCALE, ELASTICITY, RAND, SPEED) const stage_t STAGE_ ## NAME = {  \
+.engine=STAGE_ENGINE_PARTICLES,                                                               \
+STAGE_HEAD(BGNAME),                                                                           \
+.scale=SCALE,                                                                               \
+.elasticity=ELASTICITY,                                                                     \
+.rand=RAND,                                                                                 \
+.speed=SPEED,                                                                               \
+};                                                                                          \
+STAGE_CHECK_BG(NAME, BGNAME)
+
+#define STAGE_SAND(NAME, BGNAME, SCALE) const stage_t STAGE_ ## NAME = {  \
+.engine=STAGE_ENGINE_SAND,                                                \
+STAGE_HEAD(BGNAME),                                                       \
+.scale=SCALE,                                                           \
+.elasticity=0,                                                          \
+.rand=false,                                                            \
+.speed=1,                                                               \
+};                                                                      \
+STAGE_CHECK_BG(NAME, BGNAME)
+
+// Backgrounds are converted for a fixed size, see scripts/png_to_header.py
+#define STAGE_CHECK_BG(NAME, BGNAME) static_assert(sizeof(IMG_ ## BGNAME) == sizeof(uint32_t)*DISPLAY_WIDTH*DISPLAY_HEIGHT, \
+                                                   "Background of stage " #NAME " does not match the display size");
 
 // First pass for definition of config structs
 #include "active_stages.def"
 
 #undef STAGE
 #undef STAGE_ADV
+#undef STAGE_SPEED
+#undef STAGE_SAND
+#undef STAGE_CHECK_BG
 
 #define STAGE(NAME) STAGE_ ## NAME,
 #define STAGE_ADV(NAME, BGNAME, SCALE, ELASTICITY, RAND) STAGE_ ## NAME,
+#define STAGE_SPEED(NAME, BGNAME, SCALE, ELASTICITY, RAND, SPEED) STAGE_ ## NAME,
+#define STAGE_SAND(NAME, BGNAME, SCALE) STAGE_ ## NAME,
 
 // Second pass for definition of list of stages
 const stage_t stages[] = {
@@ -33,19 +68,25 @@ const stage_t stages[] = {
 
 #undef STAGE
 #undef STAGE_ADV
+#undef STAGE_SPEED
+#undef STAGE_SAND
 
 // -------------------------------------------------------------------------- //
 // Universes for Game of Life
+#define UNIVERSE_CHECK_CELLS(NAME) static_assert(sizeof(GOL_ ## NAME) == DISPLAY_WIDTH*DISPLAY_HEIGHT, \
+                                                 "Universe " #NAME " does not match the display size");
 #define UNIVERSE(NAME) const universe_t UNIVERSE_ ## NAME = { \
 .cells = GOL_ ## NAME,                                        \
 .prob = NAN,                                                  \
 .period_restart = true,                                       \
-};
+};                                                            \
+UNIVERSE_CHECK_CELLS(NAME)
 #define UNIVERSE_NOPER(NAME) const universe_t UNIVERSE_ ## NAME = { \
 .cells = GOL_ ## NAME,                                              \
 .prob = NAN,                                                        \
 .period_restart = false,                                            \
-};
+};                                                                  \
+UNIVERSE_CHECK_CELLS(NAME)
 #define RANDUNIVERSE(NAME, PROB) const universe_t UNIVERSE_ ## NAME = { \
 .cells = nullptr,                                                       \
 .prob = (PROB),                                                         \
@@ -58,6 +99,7 @@ const stage_t stages[] = {
 #undef UNIVERSE
 #undef RANDUNIVERSE
 #undef UNIVERSE_NOPER
+#undef UNIVERSE_CHECK_CELLS
 
 #define UNIVERSE(NAME) UNIVERSE_ ## NAME,
 #define UNIVERSE_NOPER(NAME) UNIVERSE_ ## NAME,
@@ -77,6 +119,8 @@ const universe_t universes[] = {
 
 #define STAGE(NAME) "Stage: " #NAME,
 #define STAGE_ADV(NAME, BGNAME, SCALE, ELASTICITY, RAND) "Stage: " #NAME,
+#define STAGE_SPEED(NAME, BGNAME, SCALE, ELASTICITY, RAND, SPEED) "Stage: " #NAME,
+#define STAGE_SAND(NAME, BGNAME, SCALE) "Stage [Sand]: " #NAME,
 
 #define UNIVERSE(NAME) "Universe: " # NAME,
 #define UNIVERSE_NOPER(NAME) "Universe [Periodic]: " # NAME,
@@ -89,6 +133,8 @@ const char* stage_names[] = {
 
 #undef STAGE
 #undef STAGE_ADV
+#undef STAGE_SPEED
+#undef STAGE_SAND
 
 #undef UNIVERSE
 #undef RANDUNIVERSE
@@ -0,0 +1,70 @@
+#include "worksplit.h"
+
+void worksplit_init(worksplit_t* w) {
+    w->lock = spin_lock_instance(spin_lock_claim_unused(true));
+    w->func = nullptr;
+    w->ctx = nullptr;
+    w->count = 0;
+    w->next = 0;
+    w->finished = 0;
+    w->helped = 0;
+}
+
+static inline bool __not_in_flash_func(worksplit_claim)(worksplit_t* w, worksplit_func_t* func, void** ctx, uint32_t* chunk) {
+    uint32_t irq = spin_lock_blocking(w->lock);
+    bool claimed = w->next < w->count;
+    if (claimed) {
+        *func = w->func;
+        *ctx = w->ctx;
+        *chunk = w->next++;
+    }
+    spin_unlock(w->lock, irq);
+    return claimed;
+}
+
+void __not_in_flash_func(worksplit_run)(worksplit_t* w, worksplit_func_t func, void* ctx, uint32_t count) {
+    uint32_t irq = spin_lock_blocking(w->lock);
+    w->func = func;
+    w->ctx = ctx;
+    w->next = 0;
+    w->finished = 0;
+    w->helped = 0;
+    w->count = count;
+    spin_unlock(w->lock, irq);
+
+    // Work on the job ourselves, the helper might not have any time at all
+    uint32_t done = 0;
+    uint32_t chunk;
+    while (worksplit_claim(w, &func, &ctx, &chunk)) {
+        func(ctx, chunk);
+        done++;
+    }
+
+    // Wait for the chunks the helper is still working on, at most one
+    irq = spin_lock_blocking(w->lock);
+    w->finished += done;
+    while (w->finished < count) {
+        spin_unlock(w->lock, irq);
+        tight_loop_contents();
+        irq = spin_lock_blocking(w->lock);
+    }
+    w->count = 0;
+    spin_unlock(w->lock, irq);
+}
+
+bool __not_in_flash_func(worksplit_help)(worksplit_t* w) {
+    worksplit_func_t func;
+    void* ctx;
+    uint32_t chunk;
+    if (!worksplit_claim(w, &func, &ctx, &chunk)) {
+        return false;
+    }
+
+    func(ctx, chunk);
+
+    uint32_t irq = spin_lock_blocking(w->lock);
+    w->finished++;
+    w->helped++;
+    spin_unlock(w->lock, irq);
+    return true;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+/*
+ * Splitting a job into chunks that two cores can work on at the same time
+ *
+ * The owner (core0) publishes a job with worksplit_run() and starts working on it
+ * itself. The helper (core1) calls worksplit_help() whenever it has some spare time,
+ * e.g. while waiting for the display PIO, and takes one chunk per call.
+ * Chunks are handed out in order, but may finish in any order, so they must not
+ * depend on each other. worksplit_run() only returns once every chunk is finished.
+ *
+ * The RP2040 has no atomic read-modify-write instructions, so a hardware spin lock
+ * protects the counters. It also makes the results of the helper visible to the owner.
+ */
+
+typedef void (*worksplit_func_t)(void* ctx, uint32_t chunk);
+
+typedef struct worksplit {
+    spin_lock_t* lock;
+
+    worksplit_func_t func;
+    void* ctx;
+    uint32_t count;     // Number of chunks of the current job
+    uint32_t next;      // Next chunk to hand out
+    uint32_t finished;  // Number of chunks done
+
+    uint32_t helped;    // Chunks done by the helper during the last job
+} worksplit_t;
+
+void worksplit_init(worksplit_t* w);
+
+// Run func for every chunk in 0..count-1, with help from the other core if it has time
+void worksplit_run(worksplit_t* w, worksplit_func_t func, void* ctx, uint32_t count);
+
+// Work on at most one chunk of the current job
+// Returns false if there was nothing to do
+bool worksplit_help(worksplit_t* w);